@@ -0,0 +1,144 @@
+/**
+ * IZP Project 2 - setcal
+ *
+ * Benchmark of the boolean matrix engines of dense relations. Compares
+ * the bitwise kernels with the Four Russians kernels on the transitive
+ * closure and the transitivity check of generated relations.
+ *
+ * Usage: setcal_bench [MAX_SIZE] [THREADS]
+ */
+
+#define SETCAL_NO_MAIN
+#include "../setcal.c"
+
+#include <time.h>
+
+#define BENCH_MIN_SIZE 512
+#define BENCH_MAX_SIZE 4096
+
+/**
+ * Generated relation shapes.
+ */
+typedef enum {
+    BENCH_RANDOM,
+    BENCH_ORDER,
+    BENCH_CLUSTERS
+} bench_shape_t;
+
+const char *bench_shapes[] = {"random", "order", "clusters"};
+
+/**
+ * Returns the monotonic time in milliseconds.
+ * @return The time.
+ */
+double bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/**
+ * Generates a relation table of the shape. Random relations have 4 pairs
+ * per element and close to the full table, orders have 4 pairs (i, j)
+ * with i < j per element and close to a partial order, clusters are
+ * disjoint cliques of 4 elements.
+ * @param universe The universe.
+ * @param shape The shape.
+ * @return The relation table.
+ */
+relation_table_t *bench_table(set_t *universe, bench_shape_t shape) {
+    relation_table_t *rt = relation_table_init(universe, universe);
+    int n = rt->rows;
+
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < 4; k++) {
+            switch (shape) {
+                case BENCH_RANDOM:
+                    relation_table_set(rt, i, rand() % n);
+                    break;
+                case BENCH_ORDER:
+                    if (i + 1 < n)
+                        relation_table_set(rt, i, i + 1 + rand() % (n - i - 1));
+                    break;
+                case BENCH_CLUSTERS:
+                    if (i - i % 4 + k < n)
+                        relation_table_set(rt, i, i - i % 4 + k);
+                    break;
+            }
+        }
+    }
+
+    return rt;
+}
+
+/**
+ * Measures the closure of the table and the profile of the closure with
+ * the algorithm. The closure is transitive, so the transitivity check
+ * cannot stop early.
+ * @param rt The relation table, not changed.
+ * @param algorithm The algorithm.
+ * @param closure_ms Output, time of the transitive closure.
+ * @param profile_ms Output, time of the profile.
+ */
+void bench_run(relation_table_t *rt, relation_algorithm_t algorithm,
+               double *closure_ms, double *profile_ms) {
+    relation_table_t *copy = relation_table_copy(rt);
+    relation_profile_t profile;
+    double start;
+
+    options.algorithm = algorithm;
+
+    start = bench_now();
+    relation_table_close_transitive(copy);
+    *closure_ms = bench_now() - start;
+
+    start = bench_now();
+    relation_table_profile(copy, &profile);
+    *profile_ms = bench_now() - start;
+
+    relation_table_free(copy);
+}
+
+int main(int argc, char *argv[]) {
+    int max_size = argc > 1 ? atoi(argv[1]) : BENCH_MAX_SIZE;
+
+    options.threads = argc > 2 ? atoi(argv[2]) : 1;
+
+    if (max_size < 1 || options.threads < 1)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid arguments");
+
+    printf("%-9s %6s %10s %10s %8s %10s %10s %8s\n", "shape", "n",
+           "closure", "4r", "speedup", "profile", "4r", "speedup");
+
+    for (int shape = BENCH_RANDOM; shape <= BENCH_CLUSTERS; shape++) {
+        for (int n = BENCH_MIN_SIZE; n <= max_size; n *= 2) {
+            set_t *universe = set_init((uint32_t) n);
+            double closure[2], profile[2];
+
+            srand(1);
+
+            for (int i = 0; i < n; i++) {
+                set_add(universe, (uint32_t) i);
+            }
+
+            set_optimize(universe);
+
+            relation_table_t *rt = bench_table(universe, shape);
+
+            bench_run(rt, RELATION_BITWISE, &closure[0], &profile[0]);
+            bench_run(rt, RELATION_FOUR_RUSSIANS, &closure[1], &profile[1]);
+
+            printf("%-9s %6d %8.1fms %8.1fms %7.2fx %8.1fms %8.1fms %7.2fx\n",
+                   bench_shapes[shape], n, closure[0], closure[1],
+                   closure[0] / closure[1], profile[0], profile[1],
+                   profile[0] / profile[1]);
+
+            relation_table_free(rt);
+            set_free(universe);
+        }
+    }
+
+    return 0;
+}
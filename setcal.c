@@ -8,6 +8,12 @@
  * - xafana01
  */
 
+/**
+ * posix_memalign and pthread barriers are POSIX, strict -std=c99 hides
+ * them without this.
+ */
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <string.h>
 #include <malloc.h>
@@ -15,11 +21,20 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #define SET_OPERATIONS_COUNT 9
-#define RELATION_OPERATIONS_COUNT 10
+#define RELATION_OPERATIONS_COUNT 13
 #define COMMON_OPERATIONS_COUNT 3
 
+/**
+ * Relations with less than 1 / RELATION_SPARSE_DENSITY of the possible pairs
+ * are checked and closed on their pairs instead of the bit matrix. Default
+ * of --sparse-density.
+ */
+#define RELATION_SPARSE_DENSITY 64
+
 /**
  * -----------------------------------------------------------------------------
  * SYSTEM MODULE
@@ -49,6 +64,109 @@ void print_error(const char *filename, int line, const char *function,
     exit(EXIT_FAILURE);
 }
 
+/**
+ * Boolean matrix engine of dense transitive closures and transitivity
+ * checks, selected by --algorithm.
+ */
+typedef enum {
+    RELATION_BITWISE,
+    RELATION_FOUR_RUSSIANS
+} relation_algorithm_t;
+
+/**
+ * Program options.
+ */
+typedef struct {
+    char *file;
+    int threads;
+    int sparse_density;
+    bool stats;
+    relation_algorithm_t algorithm;
+} options_t;
+
+options_t options = {NULL, 1, RELATION_SPARSE_DENSITY, false,
+                     RELATION_BITWISE};
+
+/**
+ * Counters of relation property queries printed by --stats: computed
+ * profiles and checks answered by known properties.
+ */
+typedef struct {
+    unsigned long profiles;
+    unsigned long known;
+} counters_t;
+
+counters_t counters = {0, 0};
+
+void options_parse(int argc, char *argv[]);
+
+/**
+ * Parses program arguments: the input file and optional --threads N,
+ * --sparse-density N, --stats and --algorithm bitwise|four-russians.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ */
+void options_parse(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0) {
+            char *end = NULL;
+
+            if (i + 1 >= argc)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Missing number of threads");
+
+            long threads = strtol(argv[++i], &end, 10);
+
+            if (*end != '\0' || threads < 1 || threads > 1024)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Invalid number of threads");
+
+            options.threads = (int) threads;
+        } else if (strcmp(argv[i], "--sparse-density") == 0) {
+            char *end = NULL;
+
+            if (i + 1 >= argc)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Missing sparse density");
+
+            long density = strtol(argv[++i], &end, 10);
+
+            if (*end != '\0' || density < 1 || density > 1048576)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Invalid sparse density");
+
+            options.sparse_density = (int) density;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options.stats = true;
+        } else if (strcmp(argv[i], "--algorithm") == 0) {
+            if (i + 1 >= argc)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Missing algorithm");
+
+            i++;
+
+            if (strcmp(argv[i], "bitwise") == 0)
+                options.algorithm = RELATION_BITWISE;
+            else if (strcmp(argv[i], "four-russians") == 0)
+                options.algorithm = RELATION_FOUR_RUSSIANS;
+            else
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Unknown algorithm");
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            print_error(__FILENAME__, __LINE__, __func__, "Unknown option");
+        } else if (options.file == NULL) {
+            options.file = argv[i];
+        } else {
+            print_error(__FILENAME__, __LINE__, __func__,
+                        "Invalid number of arguments");
+        }
+    }
+
+    if (options.file == NULL)
+        print_error(__FILENAME__, __LINE__, __func__,
+                    "Invalid number of arguments");
+}
+
 /**
  * -----------------------------------------------------------------------------
  * STRING MODULE
@@ -73,6 +191,8 @@ void remove_newlines(char *str);
 
 //char *string_duplicate(char *str);
 
+char *read_line(FILE *fp);
+
 int n_count(int n) {
     int count = 0;
     while (n != 0) {
@@ -119,7 +239,9 @@ char *pad_string(char *str, unsigned int max) {
 
 // create a function to check is string contains only characters
 bool is_string_only_characters(char *str) {
-    for (unsigned int i = 0; i < strlen(str); i++) {
+    size_t len = strlen(str);
+
+    for (size_t i = 0; i < len; i++) {
 //        printf("%c\n", str[i]);
 //        printf("%d - %d\n", isalpha(str[i]), isspace(str[i]));
         if (isalpha(str[i]) == 0 && isspace(str[i]) == 0) {
@@ -172,40 +294,44 @@ int find_substr(const char *str, const char *substr) {
 }
 
 
+/**
+ * Replaces all occurrences of a substring in one pass from left to right.
+ * @param dst The result, big enough for it. It may be the string itself
+ * when the new substring is not longer.
+ * @param str The string.
+ * @param substr The substring to be replaced.
+ * @param new_substr The substring to replace with.
+ */
 void replace_substring(char *dst, char *str, const char *substr,
                        const char *new_substr) {
-    int i, j, k, l;
-    int substr_len = (int) strlen(substr);
-    int new_substr_len = (int) strlen(new_substr);
-    int str_len = (int) strlen(str);
+    size_t substr_len = strlen(substr);
+    size_t new_substr_len = strlen(new_substr);
+    size_t str_len = strlen(str);
+    size_t k = 0;
 
-    int substr_pos = find_substr(str, substr);
-
-    if (substr_pos == -1) {
-        strcpy(dst, str);
+    if (substr_len == 0) {
+        memmove(dst, str, str_len + 1);
         return;
     }
 
-    char *new_str = malloc(str_len + 1);
+    char *new_str = malloc(str_len / substr_len * new_substr_len +
+                           str_len + 1);
 
     if (new_str == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    for (i = 0; i < substr_pos; i++)
-        new_str[i] = str[i];
-
-    for (j = 0, k = substr_pos, l = 0; l < new_substr_len; j++, k++, l++)
-        new_str[k] = new_substr[l];
-
-    for (i = substr_pos + substr_len; i < str_len; i++)
-        new_str[k++] = str[i];
+    for (size_t i = 0; i < str_len;) {
+        if (strncmp(str + i, substr, substr_len) == 0) {
+            memcpy(new_str + k, new_substr, new_substr_len);
+            k += new_substr_len;
+            i += substr_len;
+        } else {
+            new_str[k++] = str[i++];
+        }
+    }
 
     new_str[k] = '\0';
 
-    if (find_substr(new_str, substr) != -1) {
-        replace_substring(new_str, new_str, substr, new_substr);
-    }
-
     strcpy(dst, new_str);
 
     free(new_str);
@@ -218,19 +344,20 @@ void replace_substring(char *dst, char *str, const char *substr,
  * @return The string without spaces.
  */
 char *remove_char(char *str, char r) {
-    size_t len = strlen(str) + 1;
-    char new_str[len];
-    char *return_value = (char *) malloc(sizeof(char) * len);
+    size_t len = strlen(str);
+    char *return_value = (char *) malloc(sizeof(char) * (len + 1));
 
-    int j = 0;
-    for (unsigned int i = 0; i < strlen(str); i++) {
+    if (return_value == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    size_t j = 0;
+    for (size_t i = 0; i < len; i++) {
         if (str[i] != r) {
-            new_str[j] = str[i];
+            return_value[j] = str[i];
             j++;
         }
     }
-    new_str[j] = '\0';
-    strcpy(return_value, new_str);
+    return_value[j] = '\0';
     return return_value;
 }
 
@@ -253,14 +380,14 @@ void remove_spaces(char *str) {
  * @param str The string.
  */
 void remove_newlines(char *str) {
-    char *new_str = (char *) malloc(sizeof(char) * 31);
-    strcpy(new_str, remove_char(str, '\n'));
-    strcpy(new_str, remove_char(new_str, '\r'));
+    char *without_newlines = remove_char(str, '\n');
+    char *new_str = remove_char(without_newlines, '\r');
     strcpy(str, new_str);
 
     if (strcmp(str, new_str) != 0)
         print_error(__FILENAME__, __LINE__, __func__, "strcpy failed");
 
+    free(without_newlines);
     free(new_str);
 }
 
@@ -268,6 +395,45 @@ void remove_newlines(char *str) {
 void string_duplicate(char *dst, char *str) {
     strcpy(dst, str);
 }
+
+/**
+ * Reads a line of any length from the file. The buffer starts at 256
+ * characters and doubles while the line does not fit.
+ * @param fp The file.
+ * @return The line with its newline or NULL at the end of the file. The
+ * caller frees it.
+ */
+char *read_line(FILE *fp) {
+    size_t capacity = 256;
+    size_t length = 0;
+    char *line = malloc(sizeof(char) * capacity);
+
+    if (line == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    while (fgets(line + length, (int) (capacity - length), fp) != NULL) {
+        length += strlen(line + length);
+
+        if (line[length - 1] == '\n')
+            break;
+
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            line = realloc(line, sizeof(char) * capacity);
+
+            if (line == NULL)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Realloc failed");
+        }
+    }
+
+    if (length == 0) {
+        free(line);
+        return NULL;
+    }
+
+    return line;
+}
 /**
  * -----------------------------------------------------------------------------
  * VECTOR MODULE
@@ -346,10 +512,19 @@ void vector_add(vector_t *v, char *s) {
             print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
         }
 
-        v->elements[v->size] = malloc(sizeof(char) * 31);
+        v->elements[v->size] = NULL;
     }
 
-    strcpy(v->elements[v->size], remove_char(s, ' '));
+    char *element = remove_char(s, ' ');
+
+    v->elements[v->size] = realloc(v->elements[v->size],
+                                   sizeof(char) * (strlen(element) + 1));
+
+    if (v->elements[v->size] == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
+
+    strcpy(v->elements[v->size], element);
+    free(element);
     v->size++;
 }
 
@@ -364,13 +539,19 @@ void vector_add_no_transform(vector_t *v, char *s) {
         v->elements = (char **) realloc(v->elements,
                                         v->capacity * sizeof(char *));
 
-        v->elements[v->size] = malloc(sizeof(char) * (strlen(s) + 1));
-
         if (v->elements == NULL) {
             print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
         }
+
+        v->elements[v->size] = NULL;
     }
 
+    v->elements[v->size] = realloc(v->elements[v->size],
+                                   sizeof(char) * (strlen(s) + 1));
+
+    if (v->elements[v->size] == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
+
     strcpy(v->elements[v->size], s);
     v->size++;
 }
@@ -389,6 +570,8 @@ void vector_copy(vector_t *dst, vector_t *src) {
     }
 
     for (int i = 0; i < src->size; i++) {
+        dst->elements[i] = realloc(dst->elements[i], sizeof(char) *
+                                   (strlen(src->elements[i]) + 1));
         strcpy(dst->elements[i], src->elements[i]);
     }
 }
@@ -463,7 +646,13 @@ void vector_foreach(vector_t *v, void (*f)(char *)) {
 
 // create a function to convert vector args to string with delimiter
 char *vector_to_string(vector_t *v, char *delim) {
-    char *str = (char *) malloc(sizeof(char) * (v->size + 1));
+    size_t len = 1;
+
+    for (int i = 0; i < v->size; i++) {
+        len += strlen(v->elements[i]) + strlen(delim);
+    }
+
+    char *str = (char *) malloc(sizeof(char) * len);
 
     if (str == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
@@ -511,1022 +700,4020 @@ void vector_free(vector_t *v) {
 
 /**
  * -----------------------------------------------------------------------------
- * SET MODULE [SET]
+ * SYMBOL MODULE
  * -----------------------------------------------------------------------------
  */
 
+#define SYMBOL_NOT_FOUND UINT32_MAX
+
 /**
- * Set type.
+ * Symbol table type. Interns universe elements into dense IDs.
+ * Element with ID i is stored at names[i], buckets is an open addressing
+ * hash table of ID + 1 values (0 marks an empty slot).
  */
-typedef struct set {
-    unsigned int index;
-    int size;
-    int capacity;
-    char **elements;
-} set_t;
+typedef struct {
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t buckets_count;
+    char **names;
+    uint32_t *buckets;
+} symbol_table_t;
 
-set_t *set_init(int capacity);
+symbol_table_t *symbol_table_init(uint32_t capacity);
 
-set_t *set_init_indexed(int index, int capacity);
+symbol_table_t *symbol_table_init_vector(vector_t *v);
 
-int set_item_index(set_t *s, char *item);
+uint32_t symbol_table_add(symbol_table_t *st, const char *name);
 
-void set_add(set_t *s, char *e);
+uint32_t symbol_table_find(symbol_table_t *st, const char *name);
 
-void set_add_row(set_t *s, int row);
+char *symbol_table_name(symbol_table_t *st, uint32_t id);
 
-void set_print(set_t *s);
+void symbol_table_free(symbol_table_t *st);
 
-void set_free(set_t *s);
+/**
+ * Computes FNV-1a hash of the string.
+ * @param str The string.
+ * @return The hash of the string.
+ */
+uint32_t symbol_hash(const char *str) {
+    uint32_t hash = 2166136261u;
+
+    for (; *str != '\0'; str++) {
+        hash ^= (unsigned char) *str;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
 
 /**
- * Creates a new set.
- * @param capacity The initial capacity of the set.
- * @return The new set.
+ * Initializes the symbol table.
+ * @param capacity The expected number of symbols.
+ * @return The initialized symbol table.
  */
-set_t *set_init(int capacity) {
-    set_t *s = malloc(sizeof(set_t));
+symbol_table_t *symbol_table_init(uint32_t capacity) {
+    symbol_table_t *st = malloc(sizeof(symbol_table_t));
 
-    if (s == NULL)
+    if (st == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    s->index = 0;
-    s->size = 0;
-    s->capacity = capacity;
-    s->elements = malloc(sizeof(char *) * capacity);
+    if (capacity < 1)
+        capacity = 1;
+
+    st->size = 0;
+    st->capacity = capacity;
+    st->buckets_count = 2;
+
+    while (st->buckets_count < capacity * 2)
+        st->buckets_count *= 2;
 
-    if (s->elements == NULL)
+    st->names = malloc(sizeof(char *) * st->capacity);
+    st->buckets = calloc(st->buckets_count, sizeof(uint32_t));
+
+    if (st->names == NULL || st->buckets == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    return s;
+    return st;
 }
 
 /**
- * Creates a new set.
- * @param index The index of the set.
- * @param capacity The initial capacity of the set.
- * @return The new set.
+ * Initializes the symbol table from the vector items.
+ * @param v The vector with symbol names.
+ * @return The initialized symbol table.
  */
-set_t *set_init_indexed(int index, int capacity) {
-    if (index < 1)
-        print_error(__FILENAME__, __LINE__, __func__,
-                    "Index is negative or zero");
+symbol_table_t *symbol_table_init_vector(vector_t *v) {
+    symbol_table_t *st = symbol_table_init(v->size);
 
-    set_t *s = malloc(sizeof(set_t));
+    for (int i = 0; i < v->size; i++) {
+        symbol_table_add(st, v->elements[i]);
+    }
 
-    if (s == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+    return st;
+}
 
-    s->index = index;
-    s->size = 0;
-    s->capacity = capacity;
-    s->elements = malloc(sizeof(char *) * capacity);
+/**
+ * Finds the bucket slot of the symbol.
+ * @param st The symbol table.
+ * @param name The symbol name.
+ * @return The slot with the symbol or the empty slot where it belongs.
+ */
+uint32_t symbol_table_slot(symbol_table_t *st, const char *name) {
+    uint32_t mask = st->buckets_count - 1;
+    uint32_t slot = symbol_hash(name) & mask;
 
-    if (s->elements == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+    while (st->buckets[slot] != 0 &&
+           strcmp(st->names[st->buckets[slot] - 1], name) != 0) {
+        slot = (slot + 1) & mask;
+    }
 
-    return s;
+    return slot;
 }
 
 /**
- * Returns the index of the item in the set.
- * @param s The set.
- * @param item The item.
- * @return The index of the item in the set.
+ * Doubles the number of hash buckets and reinserts all symbols.
+ * @param st The symbol table.
  */
-int set_item_index(set_t *s, char *item) {
-    for (int i = 0; i < s->size; i++) {
-        if (strcmp(s->elements[i], item) == 0) {
-            return i;
-        }
+void symbol_table_grow(symbol_table_t *st) {
+    free(st->buckets);
+
+    st->buckets_count *= 2;
+    st->buckets = calloc(st->buckets_count, sizeof(uint32_t));
+
+    if (st->buckets == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    for (uint32_t i = 0; i < st->size; i++) {
+        st->buckets[symbol_table_slot(st, st->names[i])] = i + 1;
     }
-    return -1;
 }
 
 /**
- * Adds an element to the set.
- * @param s The set.
- * @param e The element to add.
+ * Adds the symbol to the symbol table.
+ * @param st The symbol table.
+ * @param name The symbol name.
+ * @return ID of the symbol. Existing ID is returned for known symbols.
  */
-void set_add(set_t *s, char *e) {
-    if (s->size == s->capacity) {
-        s->capacity += 1;
-        s->elements = realloc(s->elements, sizeof(char *) * s->capacity);
+uint32_t symbol_table_add(symbol_table_t *st, const char *name) {
+    uint32_t slot = symbol_table_slot(st, name);
+
+    if (st->buckets[slot] != 0)
+        return st->buckets[slot] - 1;
+
+    if (st->size == st->capacity) {
+        st->capacity *= 2;
+        st->names = realloc(st->names, sizeof(char *) * st->capacity);
 
-        if (s->elements == NULL)
+        if (st->names == NULL)
             print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
     }
-    s->elements[s->size] = e;
-    s->size++;
-}
 
-///**
-// * Adds a row number to the set.
-// * @param s The set.
-// * @param e The element to add.
-// */
-//void set_add_row(set_t *s, int row) {
-//    s->row = row;
-//}
+    st->names[st->size] = malloc(sizeof(char) * (strlen(name) + 1));
+
+    if (st->names[st->size] == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    strcpy(st->names[st->size], name);
+    st->buckets[slot] = st->size + 1;
+    st->size++;
+
+    if (st->size * 2 > st->buckets_count)
+        symbol_table_grow(st);
+
+    return st->size - 1;
+}
 
 /**
- * Prints the set.
- * @param s The set.
+ * Finds ID of the symbol.
+ * @param st The symbol table.
+ * @param name The symbol name.
+ * @return ID of the symbol or SYMBOL_NOT_FOUND.
  */
-void set_print(set_t *s) {
-    printf("Set %d: ", s->index);
-    for (int i = 0; i < s->size; i++) {
-        printf("%s ", s->elements[i]);
-    }
-    printf("\n");
+uint32_t symbol_table_find(symbol_table_t *st, const char *name) {
+    uint32_t slot = symbol_table_slot(st, name);
+
+    return st->buckets[slot] != 0 ? st->buckets[slot] - 1 : SYMBOL_NOT_FOUND;
 }
 
-void set_free(set_t *s) {
-    if (s == NULL) {
-        print_error(__FILENAME__, __LINE__, __func__, "Set is NULL");
-    }
+/**
+ * Returns name of the symbol.
+ * @param st The symbol table.
+ * @param id ID of the symbol.
+ * @return The symbol name.
+ */
+char *symbol_table_name(symbol_table_t *st, uint32_t id) {
+    if (id >= st->size)
+        print_error(__FILENAME__, __LINE__, __func__, "Unknown symbol");
 
-    if (s->elements == NULL) {
-        print_error(__FILENAME__, __LINE__, __func__,
-                    "Set elements are NULL");
-    }
+    return st->names[id];
+}
 
-    for (int i = 0; i < s->size; i++) {
-        if (s->elements[i] == NULL) {
-            print_error(__FILENAME__, __LINE__, __func__,
-                        "Set element is NULL");
-        }
-    }
+/**
+ * Frees the symbol table.
+ * @param st The symbol table.
+ */
+void symbol_table_free(symbol_table_t *st) {
+    if (st == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
 
-    for (int i = 0; i < s->size; i++) {
-        free(s->elements[i]);
+    for (uint32_t i = 0; i < st->size; i++) {
+        free(st->names[i]);
     }
-    free(s->elements);
-    free(s);
+
+    free(st->names);
+    free(st->buckets);
+    free(st);
 }
 
 /**
  * -----------------------------------------------------------------------------
- * SET MODULE [SET VECTOR]
+ * BITSET MODULE
  * -----------------------------------------------------------------------------
  */
 
-/**
- * Set vector type.
- */
-typedef struct set_vector_t {
-    int size;
-    int capacity;
-    set_t **sets;
-} set_vector_t;
-
-set_vector_t *set_vector_init(int capacity);
+#define BITSET_WORD_BITS 64
 
-void set_vector_add(set_vector_t *sv, set_t *s, unsigned int index);
+#if defined(__GNUC__) || defined(__clang__)
+#define bit_popcount(x) __builtin_popcountll(x)
+#define bit_ctz(x) __builtin_ctzll(x)
+#else
 
-set_t *set_vector_find(set_vector_t *sv, unsigned int index);
+/**
+ * Counts set bits in the word.
+ * @param x The word.
+ * @return Number of set bits.
+ */
+int bit_popcount(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int) ((x * 0x0101010101010101ULL) >> 56);
+}
 
-void set_vector_print(set_vector_t *sv);
+/**
+ * Counts trailing zero bits in the non-zero word.
+ * @param x The word.
+ * @return Number of trailing zero bits.
+ */
+int bit_ctz(uint64_t x) {
+    return bit_popcount((x & -x) - 1);
+}
 
-void set_vector_free(set_vector_t *sv);
+#endif
 
 /**
- * Creates a new set vector.
- * @param capacity The initial capacity of the set vector.
- * @return The new set vector.
+ * Finds next set bit in the array of words.
+ * @param words The words.
+ * @param size Number of bits stored in the words.
+ * @param from The index to start from.
+ * @return Index of the next set bit or size if there is none.
  */
-set_vector_t *set_vector_init(int capacity) {
-    if (capacity < 1)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid capacity");
+uint32_t bit_words_next(const uint64_t *words, uint32_t size, uint32_t from) {
+    if (from >= size)
+        return size;
 
-    set_vector_t *sv = malloc(sizeof(set_vector_t));
+    uint32_t words_count = (size + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+    uint32_t word = from / BITSET_WORD_BITS;
+    uint64_t bits = words[word] & (~0ULL << (from % BITSET_WORD_BITS));
 
-    if (sv == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+    while (bits == 0) {
+        word++;
 
-    sv->size = 0;
-    sv->capacity = capacity;
-    sv->sets = malloc(sizeof(set_t *) * capacity);
+        if (word >= words_count)
+            return size;
 
-    if (sv->sets == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+        bits = words[word];
+    }
 
-    return sv;
+    return word * BITSET_WORD_BITS + bit_ctz(bits);
 }
 
 /**
- * Adds a set to the set vector.
- * @param sv The set vector.
- * @param s The set to add.
- * @param index The index of the set.
+ * Transposes the 64 x 64 bit block in place, bit c of block[r] becomes
+ * bit r of block[c]. Swaps quadrants of halving width, 32 down to 1.
+ * @param block The 64 words of the block.
  */
-void set_vector_add(set_vector_t *sv, set_t *s, unsigned int index) {
-    if (sv->size == sv->capacity) {
-        sv->capacity += 1;
-        sv->sets = realloc(sv->sets, sizeof(set_t *) * sv->capacity);
+void bit_transpose(uint64_t *block) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
 
-        if (sv->sets == NULL)
-            print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
-    }
+    for (int width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (int k = 0; k < BITSET_WORD_BITS; k = ((k | width) + 1) & ~width) {
+            uint64_t t = ((block[k] >> width) ^ block[k | width]) & mask;
 
-    sv->sets[sv->size] = s;
-    sv->sets[sv->size]->index = sv->sets[sv->size]->index
-                                ? sv->sets[sv->size]->index : index;
-    sv->size++;
+            block[k] ^= t << width;
+            block[k | width] ^= t;
+        }
+    }
 }
 
 /**
- * Finds a set in the set vector.
- * @param sv The set vector.
- * @param index The index of the set.
- * @return The set.
+ * Bitset type. Bit i is stored in words[i / 64] at position i % 64.
  */
-set_t *set_vector_find(set_vector_t *sv, unsigned int index) {
-    for (int i = 0; i < sv->size; i++) {
-        if (sv->sets[i]->index == index) {
-            return sv->sets[i];
-        }
+typedef struct {
+    uint32_t size;
+    uint32_t words_count;
+    uint64_t *words;
+} bitset_t;
+
+bitset_t *bitset_init(uint32_t size);
+
+bitset_t *bitset_copy(bitset_t *b);
+
+void bitset_set(bitset_t *b, uint32_t i);
+
+void bitset_clear(bitset_t *b, uint32_t i);
+
+void bitset_set_range(bitset_t *b, uint32_t start, uint32_t end);
+
+bool bitset_test(bitset_t *b, uint32_t i);
+
+uint32_t bitset_count(bitset_t *b);
+
+bool bitset_any(bitset_t *b);
+
+uint32_t bitset_next(bitset_t *b, uint32_t from);
+
+uint32_t bitset_runs(bitset_t *b);
+
+void bitset_free(bitset_t *b);
+
+/**
+ * Returns number of words needed for the bits.
+ * @param size Number of bits.
+ * @return Number of words.
+ */
+uint32_t bitset_words(uint32_t size) {
+    return (size + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+/**
+ * Initializes an empty bitset.
+ * @param size Number of bits.
+ * @return The initialized bitset.
+ */
+bitset_t *bitset_init(uint32_t size) {
+    bitset_t *b = malloc(sizeof(bitset_t));
+
+    if (b == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    b->size = size;
+    b->words_count = bitset_words(size);
+    b->words = calloc(b->words_count > 0 ? b->words_count : 1,
+                      sizeof(uint64_t));
+
+    if (b->words == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    return b;
+}
+
+/**
+ * Copies the bitset.
+ * @param b The bitset.
+ * @return The copy of the bitset.
+ */
+bitset_t *bitset_copy(bitset_t *b) {
+    bitset_t *copy = bitset_init(b->size);
+
+    memcpy(copy->words, b->words, sizeof(uint64_t) * b->words_count);
+
+    return copy;
+}
+
+/**
+ * Sets the bit.
+ * @param b The bitset.
+ * @param i Index of the bit.
+ */
+void bitset_set(bitset_t *b, uint32_t i) {
+    if (i >= b->size)
+        print_error(__FILENAME__, __LINE__, __func__, "Index out of bounds");
+
+    b->words[i / BITSET_WORD_BITS] |= 1ULL << (i % BITSET_WORD_BITS);
+}
+
+/**
+ * Clears the bit.
+ * @param b The bitset.
+ * @param i Index of the bit.
+ */
+void bitset_clear(bitset_t *b, uint32_t i) {
+    if (i >= b->size)
+        print_error(__FILENAME__, __LINE__, __func__, "Index out of bounds");
+
+    b->words[i / BITSET_WORD_BITS] &= ~(1ULL << (i % BITSET_WORD_BITS));
+}
+
+/**
+ * Sets all bits in the range.
+ * @param b The bitset.
+ * @param start Index of the first bit.
+ * @param end Index after the last bit.
+ */
+void bitset_set_range(bitset_t *b, uint32_t start, uint32_t end) {
+    if (end > b->size || start > end)
+        print_error(__FILENAME__, __LINE__, __func__, "Index out of bounds");
+
+    if (start == end)
+        return;
+
+    uint32_t first = start / BITSET_WORD_BITS;
+    uint32_t last = (end - 1) / BITSET_WORD_BITS;
+    uint64_t first_mask = ~0ULL << (start % BITSET_WORD_BITS);
+    uint64_t last_mask = ~0ULL >> (BITSET_WORD_BITS - 1 -
+                                   (end - 1) % BITSET_WORD_BITS);
+
+    if (first == last) {
+        b->words[first] |= first_mask & last_mask;
+        return;
     }
-    return NULL;
+
+    b->words[first] |= first_mask;
+
+    for (uint32_t i = first + 1; i < last; i++) {
+        b->words[i] = ~0ULL;
+    }
+
+    b->words[last] |= last_mask;
 }
 
 /**
- * Prints the set vector.
- * @param sv The set vector.
+ * Tests the bit.
+ * @param b The bitset.
+ * @param i Index of the bit.
+ * @return True if the bit is set, false otherwise.
  */
-void set_vector_print(set_vector_t *sv) {
-    for (int i = 0; i < sv->size; i++) {
-        set_print(sv->sets[i]);
+bool bitset_test(bitset_t *b, uint32_t i) {
+    if (i >= b->size)
+        return false;
+
+    return (b->words[i / BITSET_WORD_BITS] >> (i % BITSET_WORD_BITS)) & 1ULL;
+}
+
+/**
+ * Counts set bits.
+ * @param b The bitset.
+ * @return Number of set bits.
+ */
+uint32_t bitset_count(bitset_t *b) {
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < b->words_count; i++) {
+        count += bit_popcount(b->words[i]);
     }
+
+    return count;
 }
 
-void set_vector_free(set_vector_t *sv) {
-    for (int i = 0; i < sv->size; i++) {
-        set_free(sv->sets[i]);
+/**
+ * Checks if any bit is set.
+ * @param b The bitset.
+ * @return True if at least one bit is set, false otherwise.
+ */
+bool bitset_any(bitset_t *b) {
+    for (uint32_t i = 0; i < b->words_count; i++) {
+        if (b->words[i] != 0)
+            return true;
     }
-    free(sv->sets);
-    free(sv);
+
+    return false;
+}
+
+/**
+ * Finds the next set bit.
+ * @param b The bitset.
+ * @param from Index to start searching from.
+ * @return Index of the next set bit or size of the bitset if there is none.
+ */
+uint32_t bitset_next(bitset_t *b, uint32_t from) {
+    return bit_words_next(b->words, b->size, from);
+}
+
+/**
+ * Counts runs of consecutive set bits.
+ * @param b The bitset.
+ * @return Number of runs.
+ */
+uint32_t bitset_runs(bitset_t *b) {
+    uint32_t runs = 0;
+    uint64_t carry = 0;
+
+    for (uint32_t i = 0; i < b->words_count; i++) {
+        uint64_t word = b->words[i];
+
+        runs += bit_popcount(word & ~((word << 1) | carry));
+        carry = word >> (BITSET_WORD_BITS - 1);
+    }
+
+    return runs;
+}
+
+/**
+ * Frees the bitset.
+ * @param b The bitset.
+ */
+void bitset_free(bitset_t *b) {
+    if (b == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+
+    free(b->words);
+    free(b);
 }
 
 /**
  * -----------------------------------------------------------------------------
- * SET MODULE [SET MATH]
+ * SET MODULE [SET]
  * -----------------------------------------------------------------------------
  */
 
-bool _set_is_empty(set_t *s);
+/**
+ * Set container types.
+ * Array container stores sorted element IDs, bitset container stores one bit
+ * per universe element, run container stores sorted [start, end) ranges.
+ */
+typedef enum {
+    SET_ARRAY,
+    SET_BITSET,
+    SET_RUN,
+} set_container_t;
 
-bool set_is_empty(int n, ...);
+/**
+ * Set type. Elements are universe IDs stored in the container chosen by
+ * density of the set. For array container count is the number of IDs, for
+ * run container count is the number of runs and items holds start and end
+ * of each run.
+ */
+typedef struct set {
+    unsigned int index;
+    uint32_t universe_size;
+    set_container_t container;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *items;
+    bitset_t *bits;
+    symbol_table_t *symbols;
+} set_t;
 
-int _set_card(set_t *s);
+/**
+ * Set iterator. Yields element IDs in ascending order.
+ */
+typedef struct {
+    set_t *set;
+    uint32_t position;
+    uint32_t id;
+    bool started;
+} set_iterator_t;
 
-int set_card(int n, ...);
+set_t *set_init(int capacity);
 
-set_t *_set_complement(set_t *s1, set_t *s2);
+set_t *set_init_indexed(int index, int capacity);
 
-set_t *set_complement(int n, ...);
+set_t *set_copy(set_t *s);
 
-set_t *_set_union(set_t *s1, set_t *s2);
+bool set_contains(set_t *s, uint32_t item);
 
-set_t *set_union(int n, ...);
+void set_add(set_t *s, uint32_t e);
 
-set_t *_set_intersection(set_t *s1, set_t *s2);
+void set_add_row(set_t *s, int row);
 
-set_t *set_intersection(int n, ...);
+void set_convert(set_t *s, set_container_t container);
 
-set_t *_set_diff(set_t *s1, set_t *s2);
+void set_optimize(set_t *s);
 
-set_t *set_diff(int n, ...);
+void set_iterator_init(set_iterator_t *it, set_t *s);
 
-bool _set_is_subseteq(set_t *s1, set_t *s2);
+bool set_iterator_next(set_iterator_t *it);
 
-bool set_is_subseteq(int n, ...);
+bitset_t *set_to_bitset(set_t *s);
 
-bool _set_is_subset(set_t *s1, set_t *s2);
+void set_print(set_t *s);
 
-bool set_is_subset(int n, ...);
+void set_free(set_t *s);
 
-bool _set_is_equal(set_t *s1, set_t *s2);
+/**
+ * Returns maximum number of IDs for which array container is not bigger
+ * than bitset container.
+ * @param universe_size The size of the universe.
+ * @return Maximum size of the array container.
+ */
+uint32_t set_array_limit(uint32_t universe_size) {
+    return 2 * bitset_words(universe_size);
+}
 
-bool set_is_equal(int n, ...);
+/**
+ * Creates a new set.
+ * @param capacity The size of the universe the set is drawn from.
+ * @return The new set.
+ */
+set_t *set_init(int capacity) {
+    set_t *s = malloc(sizeof(set_t));
+
+    if (s == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    s->index = 0;
+    s->universe_size = capacity > 0 ? capacity : 0;
+    s->container = SET_ARRAY;
+    s->count = 0;
+    s->capacity = 0;
+    s->items = NULL;
+    s->bits = NULL;
+    s->symbols = NULL;
+
+    return s;
+}
 
 /**
- * Checks if a set is empty.
+ * Creates a new set.
+ * @param index The index of the set.
+ * @param capacity The size of the universe the set is drawn from.
+ * @return The new set.
+ */
+set_t *set_init_indexed(int index, int capacity) {
+    if (index < 1)
+        print_error(__FILENAME__, __LINE__, __func__,
+                    "Index is negative or zero");
+
+    set_t *s = set_init(capacity);
+    s->index = index;
+
+    return s;
+}
+
+/**
+ * Creates an empty set drawn from the same universe as the given set.
  * @param s The set.
- * @return True if the set is empty, false otherwise.
+ * @return The new set.
  */
-bool _set_is_empty(set_t *s) {
-    return s->size == 0;
+set_t *set_init_like(set_t *s) {
+    set_t *result = set_init((int) s->universe_size);
+    result->symbols = s->symbols;
+
+    return result;
 }
+
 /**
- * Checks if a set is empty.
- * @param n The number of sets.
- * @param ... The sets.
- * @return True if the set is empty, false otherwise.
+ * Ensures the items buffer can hold the given number of values.
+ * @param s The set.
+ * @param capacity Number of values.
  */
-bool set_is_empty(int n, ...) {
-    va_list args;
-    va_start(args, n);
+void set_reserve(set_t *s, uint32_t capacity) {
+    if (capacity <= s->capacity)
+        return;
 
-    for (int i = 0; i < n; i++) {
-        set_t *s = va_arg(args, set_t *);
-        if (!_set_is_empty(s)) {
-            va_end(args);
-            return false;
+    uint32_t new_capacity = s->capacity > 0 ? s->capacity : 4;
+
+    while (new_capacity < capacity)
+        new_capacity *= 2;
+
+    s->items = realloc(s->items, sizeof(uint32_t) * new_capacity);
+
+    if (s->items == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
+
+    s->capacity = new_capacity;
+}
+
+/**
+ * Copies the set.
+ * @param s The set.
+ * @return The copy of the set.
+ */
+set_t *set_copy(set_t *s) {
+    set_t *copy = set_init_like(s);
+    copy->container = s->container;
+    copy->count = s->count;
+
+    if (s->container == SET_BITSET) {
+        copy->bits = bitset_copy(s->bits);
+    } else {
+        uint32_t values = s->container == SET_RUN ? 2 * s->count : s->count;
+
+        set_reserve(copy, values);
+
+        if (values > 0)
+            memcpy(copy->items, s->items, sizeof(uint32_t) * values);
+    }
+
+    return copy;
+}
+
+/**
+ * Finds position of the first array item not less than the ID.
+ * @param items Sorted array.
+ * @param count Number of items.
+ * @param stride Distance between compared items.
+ * @param id The ID.
+ * @return Position of the item.
+ */
+uint32_t set_lower_bound(uint32_t *items, uint32_t count, uint32_t stride,
+                         uint32_t id) {
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (items[middle * stride] < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
     }
 
-    va_end(args);
-    return true;
+    return low;
 }
 
 /**
- * Counts the number of elements in a set.
+ * Checks if the item is in the set.
  * @param s The set.
- * @return The number of elements in the set.
+ * @param item ID of the item.
+ * @return True if the set contains the item, false otherwise.
  */
-int _set_card(set_t *s) {
-    return s->size;
+bool set_contains(set_t *s, uint32_t item) {
+    switch (s->container) {
+        case SET_BITSET:
+            return bitset_test(s->bits, item);
+        case SET_RUN: {
+            uint32_t run = set_lower_bound(s->items, s->count, 2, item + 1);
+
+            return run > 0 && item < s->items[2 * (run - 1) + 1];
+        }
+        case SET_ARRAY:
+        default: {
+            uint32_t position = set_lower_bound(s->items, s->count, 1, item);
+
+            return position < s->count && s->items[position] == item;
+        }
+    }
 }
 
 /**
- * Counts the number of elements in a set.
- * @param n The number of sets.
- * @param ... The sets.
- * @return The number of elements in the set.
+ * Adds an element to the set. Array container grows into bitset container
+ * when it becomes bigger than the bitset.
+ * @param s The set.
+ * @param e ID of the element to add.
  */
-int set_card(int n, ...) {
-    va_list args;
-    va_start(args, n);
+void set_add(set_t *s, uint32_t e) {
+    if (e >= s->universe_size)
+        print_error(__FILENAME__, __LINE__, __func__, "Index out of bounds");
 
-    int count = 0;
-    for (int i = 0; i < n; i++) {
-        set_t *s = va_arg(args, set_t *);
-        count += _set_card(s);
+    if (s->container == SET_RUN)
+        set_convert(s, SET_BITSET);
+
+    if (s->container == SET_BITSET) {
+        bitset_set(s->bits, e);
+        return;
+    }
+
+    uint32_t position = set_lower_bound(s->items, s->count, 1, e);
+
+    if (position < s->count && s->items[position] == e)
+        return;
+
+    if (s->count + 1 > set_array_limit(s->universe_size)) {
+        set_convert(s, SET_BITSET);
+        bitset_set(s->bits, e);
+        return;
+    }
+
+    set_reserve(s, s->count + 1);
+    memmove(s->items + position + 1, s->items + position,
+            sizeof(uint32_t) * (s->count - position));
+    s->items[position] = e;
+    s->count++;
+}
+
+///**
+// * Adds a row number to the set.
+// * @param s The set.
+// * @param e The element to add.
+// */
+//void set_add_row(set_t *s, int row) {
+//    s->row = row;
+//}
+
+/**
+ * Initializes the set iterator.
+ * @param it The iterator.
+ * @param s The set.
+ */
+void set_iterator_init(set_iterator_t *it, set_t *s) {
+    it->set = s;
+    it->position = 0;
+    it->id = 0;
+    it->started = false;
+}
+
+/**
+ * Moves the iterator to the next element.
+ * @param it The iterator.
+ * @return True if the iterator points to an element, false at the end.
+ */
+bool set_iterator_next(set_iterator_t *it) {
+    set_t *s = it->set;
+
+    switch (s->container) {
+        case SET_BITSET:
+            it->id = bitset_next(s->bits, it->started ? it->id + 1 : 0);
+            it->started = true;
+            return it->id < s->bits->size;
+        case SET_RUN:
+            if (!it->started) {
+                it->started = true;
+
+                if (s->count == 0)
+                    return false;
+
+                it->id = s->items[0];
+                return true;
+            }
+
+            if (it->position >= s->count)
+                return false;
+
+            it->id++;
+
+            if (it->id >= s->items[2 * it->position + 1]) {
+                it->position++;
+
+                if (it->position >= s->count)
+                    return false;
+
+                it->id = s->items[2 * it->position];
+            }
+
+            return true;
+        case SET_ARRAY:
+        default:
+            if (it->position >= s->count)
+                return false;
+
+            it->id = s->items[it->position++];
+            return true;
+    }
+}
+
+/**
+ * Creates a bitset with elements of the set.
+ * @param s The set.
+ * @return The bitset.
+ */
+bitset_t *set_to_bitset(set_t *s) {
+    if (s->container == SET_BITSET)
+        return bitset_copy(s->bits);
+
+    bitset_t *b = bitset_init(s->universe_size);
+
+    if (s->container == SET_RUN) {
+        for (uint32_t i = 0; i < s->count; i++) {
+            bitset_set_range(b, s->items[2 * i], s->items[2 * i + 1]);
+        }
+    } else {
+        for (uint32_t i = 0; i < s->count; i++) {
+            bitset_set(b, s->items[i]);
+        }
+    }
+
+    return b;
+}
+
+/**
+ * Returns bitset with elements of the set without copying bitset container.
+ * Must be released by set_bits_release.
+ * @param s The set.
+ * @return The bitset.
+ */
+bitset_t *set_bits_view(set_t *s) {
+    return s->container == SET_BITSET ? s->bits : set_to_bitset(s);
+}
+
+/**
+ * Releases bitset returned by set_bits_view.
+ * @param s The set.
+ * @param b The bitset.
+ */
+void set_bits_release(set_t *s, bitset_t *b) {
+    if (b != s->bits)
+        bitset_free(b);
+}
+
+/**
+ * Converts the set to another container type.
+ * @param s The set.
+ * @param container The container type.
+ */
+void set_convert(set_t *s, set_container_t container) {
+    if (s->container == container)
+        return;
+
+    set_t *converted = set_init_like(s);
+    converted->container = container;
+
+    if (container == SET_BITSET) {
+        converted->bits = set_to_bitset(s);
+    } else {
+        set_iterator_t it;
+
+        for (set_iterator_init(&it, s); set_iterator_next(&it);) {
+            if (container == SET_ARRAY) {
+                set_reserve(converted, converted->count + 1);
+                converted->items[converted->count++] = it.id;
+            } else if (converted->count > 0 &&
+                       converted->items[2 * converted->count - 1] == it.id) {
+                converted->items[2 * converted->count - 1]++;
+            } else {
+                set_reserve(converted, 2 * converted->count + 2);
+                converted->items[2 * converted->count] = it.id;
+                converted->items[2 * converted->count + 1] = it.id + 1;
+                converted->count++;
+            }
+        }
+    }
+
+    free(s->items);
+
+    if (s->bits != NULL)
+        bitset_free(s->bits);
+
+    s->container = converted->container;
+    s->count = converted->count;
+    s->capacity = converted->capacity;
+    s->items = converted->items;
+    s->bits = converted->bits;
+
+    free(converted);
+}
+
+/**
+ * Counts runs of consecutive elements in the set.
+ * @param s The set.
+ * @return Number of runs.
+ */
+uint32_t set_runs_count(set_t *s) {
+    switch (s->container) {
+        case SET_BITSET:
+            return bitset_runs(s->bits);
+        case SET_RUN:
+            return s->count;
+        case SET_ARRAY:
+        default: {
+            uint32_t runs = s->count > 0;
+
+            for (uint32_t i = 1; i < s->count; i++) {
+                if (s->items[i] != s->items[i - 1] + 1)
+                    runs++;
+            }
+
+            return runs;
+        }
+    }
+}
+
+/**
+ * Converts the set to the smallest container for its elements.
+ * @param s The set.
+ */
+void set_optimize(set_t *s) {
+    uint32_t card;
+
+    if (s->container == SET_ARRAY) {
+        card = s->count;
+    } else if (s->container == SET_BITSET) {
+        card = bitset_count(s->bits);
+    } else {
+        card = 0;
+
+        for (uint32_t i = 0; i < s->count; i++) {
+            card += s->items[2 * i + 1] - s->items[2 * i];
+        }
+    }
+
+    uint64_t array_size = (uint64_t) card;
+    uint64_t bitset_size = 2 * (uint64_t) bitset_words(s->universe_size);
+    uint64_t run_size = 2 * (uint64_t) set_runs_count(s);
+
+    if (run_size < array_size && run_size < bitset_size) {
+        set_convert(s, SET_RUN);
+    } else if (array_size <= bitset_size) {
+        set_convert(s, SET_ARRAY);
+    } else {
+        set_convert(s, SET_BITSET);
+    }
+}
+
+/**
+ * Prints the set.
+ * @param s The set.
+ */
+void set_print(set_t *s) {
+    set_iterator_t it;
+
+    printf("Set %d: ", s->index);
+    for (set_iterator_init(&it, s); set_iterator_next(&it);) {
+        printf("%s ", symbol_table_name(s->symbols, it.id));
+    }
+    printf("\n");
+}
+
+void set_free(set_t *s) {
+    if (s == NULL) {
+        print_error(__FILENAME__, __LINE__, __func__, "Set is NULL");
+    }
+
+    if (s->container == SET_BITSET && s->bits == NULL) {
+        print_error(__FILENAME__, __LINE__, __func__,
+                    "Set elements are NULL");
+    }
+
+    free(s->items);
+
+    if (s->bits != NULL)
+        bitset_free(s->bits);
+
+    free(s);
+}
+
+/**
+ * -----------------------------------------------------------------------------
+ * SET MODULE [SET VECTOR]
+ * -----------------------------------------------------------------------------
+ */
+
+/**
+ * Set vector type.
+ */
+typedef struct set_vector_t {
+    int size;
+    int capacity;
+    set_t **sets;
+} set_vector_t;
+
+set_vector_t *set_vector_init(int capacity);
+
+void set_vector_add(set_vector_t *sv, set_t *s, unsigned int index);
+
+set_t *set_vector_find(set_vector_t *sv, unsigned int index);
+
+void set_vector_print(set_vector_t *sv);
+
+void set_vector_free(set_vector_t *sv);
+
+/**
+ * Creates a new set vector.
+ * @param capacity The initial capacity of the set vector.
+ * @return The new set vector.
+ */
+set_vector_t *set_vector_init(int capacity) {
+    if (capacity < 1)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid capacity");
+
+    set_vector_t *sv = malloc(sizeof(set_vector_t));
+
+    if (sv == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    sv->size = 0;
+    sv->capacity = capacity;
+    sv->sets = malloc(sizeof(set_t *) * capacity);
+
+    if (sv->sets == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    return sv;
+}
+
+/**
+ * Adds a set to the set vector.
+ * @param sv The set vector.
+ * @param s The set to add.
+ * @param index The index of the set.
+ */
+void set_vector_add(set_vector_t *sv, set_t *s, unsigned int index) {
+    if (sv->size == sv->capacity) {
+        sv->capacity += 1;
+        sv->sets = realloc(sv->sets, sizeof(set_t *) * sv->capacity);
+
+        if (sv->sets == NULL)
+            print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
+    }
+
+    sv->sets[sv->size] = s;
+    sv->sets[sv->size]->index = sv->sets[sv->size]->index
+                                ? sv->sets[sv->size]->index : index;
+    sv->size++;
+}
+
+/**
+ * Finds a set in the set vector.
+ * @param sv The set vector.
+ * @param index The index of the set.
+ * @return The set.
+ */
+set_t *set_vector_find(set_vector_t *sv, unsigned int index) {
+    for (int i = 0; i < sv->size; i++) {
+        if (sv->sets[i]->index == index) {
+            return sv->sets[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Prints the set vector.
+ * @param sv The set vector.
+ */
+void set_vector_print(set_vector_t *sv) {
+    for (int i = 0; i < sv->size; i++) {
+        set_print(sv->sets[i]);
+    }
+}
+
+void set_vector_free(set_vector_t *sv) {
+    for (int i = 0; i < sv->size; i++) {
+        set_free(sv->sets[i]);
+    }
+    free(sv->sets);
+    free(sv);
+}
+
+/**
+ * -----------------------------------------------------------------------------
+ * SET MODULE [SET MATH]
+ * -----------------------------------------------------------------------------
+ */
+
+bool _set_is_empty(set_t *s);
+
+bool set_is_empty(int n, ...);
+
+int _set_card(set_t *s);
+
+int set_card(int n, ...);
+
+set_t *_set_complement(set_t *s1, set_t *s2);
+
+set_t *set_complement(int n, ...);
+
+set_t *_set_union(set_t *s1, set_t *s2);
+
+set_t *set_union(int n, ...);
+
+set_t *_set_intersection(set_t *s1, set_t *s2);
+
+set_t *set_intersection(int n, ...);
+
+set_t *_set_diff(set_t *s1, set_t *s2);
+
+set_t *set_diff(int n, ...);
+
+bool _set_is_subseteq(set_t *s1, set_t *s2);
+
+bool set_is_subseteq(int n, ...);
+
+bool _set_is_subset(set_t *s1, set_t *s2);
+
+bool set_is_subset(int n, ...);
+
+bool _set_is_equal(set_t *s1, set_t *s2);
+
+bool set_is_equal(int n, ...);
+
+/**
+ * Binary set operations supported by the container kernels.
+ */
+typedef enum {
+    SET_OP_UNION,
+    SET_OP_INTERSECTION,
+    SET_OP_DIFF,
+} set_operation_t;
+
+/**
+ * Appends an ID to the array container.
+ * @param s The set.
+ * @param id The ID.
+ */
+void set_array_append(set_t *s, uint32_t id) {
+    set_reserve(s, s->count + 1);
+    s->items[s->count++] = id;
+}
+
+/**
+ * Appends a run to the run container. Overlapping and adjacent runs are
+ * merged with the last run.
+ * @param s The set.
+ * @param start The first ID of the run.
+ * @param end The ID after the last ID of the run.
+ */
+void set_run_append(set_t *s, uint32_t start, uint32_t end) {
+    if (s->count > 0 && start <= s->items[2 * s->count - 1]) {
+        if (end > s->items[2 * s->count - 1])
+            s->items[2 * s->count - 1] = end;
+        return;
+    }
+
+    set_reserve(s, 2 * s->count + 2);
+    s->items[2 * s->count] = start;
+    s->items[2 * s->count + 1] = end;
+    s->count++;
+}
+
+/**
+ * Applies the operation to two bitsets word by word. Containers of other
+ * types are materialized as bitsets.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @param op The operation.
+ * @return The result set with bitset container.
+ */
+set_t *set_bitset_operation(set_t *s1, set_t *s2, set_operation_t op) {
+    set_t *s = set_init_like(s1);
+    bitset_t *b2 = set_bits_view(s2);
+
+    s->container = SET_BITSET;
+    s->bits = set_to_bitset(s1);
+
+    for (uint32_t i = 0; i < s->bits->words_count; i++) {
+        if (op == SET_OP_UNION) {
+            s->bits->words[i] |= b2->words[i];
+        } else if (op == SET_OP_INTERSECTION) {
+            s->bits->words[i] &= b2->words[i];
+        } else {
+            s->bits->words[i] &= ~b2->words[i];
+        }
+    }
+
+    set_bits_release(s2, b2);
+
+    return s;
+}
+
+/**
+ * Applies the operation to two array containers by merging sorted IDs.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @param op The operation.
+ * @return The result set with array container.
+ */
+set_t *set_array_operation(set_t *s1, set_t *s2, set_operation_t op) {
+    set_t *s = set_init_like(s1);
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    while (i < s1->count && j < s2->count) {
+        if (s1->items[i] < s2->items[j]) {
+            if (op != SET_OP_INTERSECTION)
+                set_array_append(s, s1->items[i]);
+            i++;
+        } else if (s1->items[i] > s2->items[j]) {
+            if (op == SET_OP_UNION)
+                set_array_append(s, s2->items[j]);
+            j++;
+        } else {
+            if (op != SET_OP_DIFF)
+                set_array_append(s, s1->items[i]);
+            i++;
+            j++;
+        }
+    }
+
+    for (; op != SET_OP_INTERSECTION && i < s1->count; i++) {
+        set_array_append(s, s1->items[i]);
+    }
+
+    for (; op == SET_OP_UNION && j < s2->count; j++) {
+        set_array_append(s, s2->items[j]);
+    }
+
+    return s;
+}
+
+/**
+ * Filters array container by membership in another set of any container.
+ * @param array The set with array container.
+ * @param s The set to test membership in.
+ * @param contained Keep contained IDs (intersection) or the others (diff).
+ * @return The result set with array container.
+ */
+set_t *set_array_filter(set_t *array, set_t *s, bool contained) {
+    set_t *result = set_init_like(array);
+
+    for (uint32_t i = 0; i < array->count; i++) {
+        if (set_contains(s, array->items[i]) == contained)
+            set_array_append(result, array->items[i]);
+    }
+
+    return result;
+}
+
+/**
+ * Applies union or intersection to two run containers.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @param op The operation.
+ * @return The result set with run container.
+ */
+set_t *set_run_operation(set_t *s1, set_t *s2, set_operation_t op) {
+    set_t *s = set_init_like(s1);
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    s->container = SET_RUN;
+
+    while (i < s1->count && j < s2->count) {
+        uint32_t *a = s1->items + 2 * i;
+        uint32_t *b = s2->items + 2 * j;
+
+        if (op == SET_OP_UNION) {
+            if (a[0] <= b[0]) {
+                set_run_append(s, a[0], a[1]);
+                i++;
+            } else {
+                set_run_append(s, b[0], b[1]);
+                j++;
+            }
+            continue;
+        }
+
+        uint32_t start = a[0] > b[0] ? a[0] : b[0];
+        uint32_t end = a[1] < b[1] ? a[1] : b[1];
+
+        if (start < end)
+            set_run_append(s, start, end);
+
+        if (a[1] < b[1]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+
+    for (; op == SET_OP_UNION && i < s1->count; i++) {
+        set_run_append(s, s1->items[2 * i], s1->items[2 * i + 1]);
+    }
+
+    for (; op == SET_OP_UNION && j < s2->count; j++) {
+        set_run_append(s, s2->items[2 * j], s2->items[2 * j + 1]);
+    }
+
+    return s;
+}
+
+/**
+ * Applies the operation choosing the kernel by the container pair.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @param op The operation.
+ * @return The result set in the smallest container.
+ */
+set_t *set_operation(set_t *s1, set_t *s2, set_operation_t op) {
+    set_t *s;
+
+    if (s1->container == SET_ARRAY && s2->container == SET_ARRAY) {
+        s = set_array_operation(s1, s2, op);
+    } else if (op != SET_OP_UNION && s1->container == SET_ARRAY) {
+        s = set_array_filter(s1, s2, op == SET_OP_INTERSECTION);
+    } else if (op == SET_OP_INTERSECTION && s2->container == SET_ARRAY) {
+        s = set_array_filter(s2, s1, true);
+    } else if (op != SET_OP_DIFF && s1->container == SET_RUN &&
+               s2->container == SET_RUN) {
+        s = set_run_operation(s1, s2, op);
+    } else {
+        s = set_bitset_operation(s1, s2, op);
+    }
+
+    set_optimize(s);
+
+    return s;
+}
+
+/**
+ * Checks if a set is empty.
+ * @param s The set.
+ * @return True if the set is empty, false otherwise.
+ */
+bool _set_is_empty(set_t *s) {
+    if (s->container == SET_BITSET)
+        return !bitset_any(s->bits);
+
+    return s->count == 0;
+}
+/**
+ * Checks if a set is empty.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return True if the set is empty, false otherwise.
+ */
+bool set_is_empty(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    for (int i = 0; i < n; i++) {
+        set_t *s = va_arg(args, set_t *);
+        if (!_set_is_empty(s)) {
+            va_end(args);
+            return false;
+        }
+    }
+
+    va_end(args);
+    return true;
+}
+
+/**
+ * Counts the number of elements in a set.
+ * @param s The set.
+ * @return The number of elements in the set.
+ */
+int _set_card(set_t *s) {
+    if (s->container == SET_BITSET)
+        return (int) bitset_count(s->bits);
+
+    if (s->container == SET_ARRAY)
+        return (int) s->count;
+
+    int card = 0;
+
+    for (uint32_t i = 0; i < s->count; i++) {
+        card += (int) (s->items[2 * i + 1] - s->items[2 * i]);
+    }
+
+    return card;
+}
+
+/**
+ * Counts the number of elements in a set.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return The number of elements in the set.
+ */
+int set_card(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        set_t *s = va_arg(args, set_t *);
+        count += _set_card(s);
+    }
+
+    va_end(args);
+    return count;
+}
+
+/**
+ * Computes the complement of a set.
+ * @param s1 The set.
+ * @param s2 The set.
+ * @return The complement of the set.
+ */
+set_t *_set_complement(set_t *s1, set_t *s2) {
+    return _set_diff(s1, s2);
+}
+
+/**
+ * Computes the complement of a set.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return The complement of the set.
+ */
+set_t *set_complement(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    set_t *s1 = va_arg(args, set_t *);
+    set_t *s2 = va_arg(args, set_t *);
+
+    va_end(args);
+    return _set_complement(s1, s2);
+}
+
+/**
+ * Returns the union of two sets.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return The union of the two sets.
+ */
+set_t *_set_union(set_t *s1, set_t *s2) {
+    return set_operation(s1, s2, SET_OP_UNION);
+}
+
+/**
+ * Returns the union of sets.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return The union of the sets.
+ */
+set_t *set_union(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s = va_arg(sets, set_t *);
+
+    for (int i = 1; i < n; i++) {
+        set_t *s_i = va_arg(sets, set_t *);
+        set_t *s_union = _set_union(s, s_i);
+        s = s_union;
+    }
+
+    va_end(sets);
+
+    return s;
+}
+
+/**
+ * Returns the intersection of sets.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return The intersection of the sets.
+ */
+set_t *_set_intersection(set_t *s1, set_t *s2) {
+    return set_operation(s1, s2, SET_OP_INTERSECTION);
+}
+
+/**
+ * Returns the intersection of sets.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return The intersection of the sets.
+ */
+set_t *set_intersection(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s = va_arg(sets, set_t *);
+
+    for (int i = 1; i < n; i++) {
+        set_t *s_i = va_arg(sets, set_t *);
+        set_t *s_intersection = _set_intersection(s, s_i);
+        s = s_intersection;
+    }
+
+    va_end(sets);
+
+    return s;
+}
+
+/**
+ * Difference of two sets.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return The difference of the two sets.
+ */
+set_t *_set_diff(set_t *s1, set_t *s2) {
+    return set_operation(s1, s2, SET_OP_DIFF);
+}
+
+/**
+ * Difference of sets.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return The difference of the sets.
+ */
+set_t *set_diff(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s = va_arg(sets, set_t *);
+
+    for (int i = 1; i < n; i++) {
+        set_t *s_i = va_arg(sets, set_t *);
+        set_t *s_diff = _set_diff(s, s_i);
+        s = s_diff;
+    }
+
+    va_end(sets);
+
+    return s;
+}
+
+/**
+ * Checks if the first set is a subset of the second set.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return true if the first set is a subset of the second set, false otherwise.
+ */
+bool _set_is_subseteq(set_t *s1, set_t *s2) {
+    if (s1->container == SET_ARRAY) {
+        for (uint32_t i = 0; i < s1->count; i++) {
+            if (!set_contains(s2, s1->items[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    if (s1->container == SET_RUN && s2->container == SET_RUN) {
+        for (uint32_t i = 0; i < s1->count; i++) {
+            uint32_t start = s1->items[2 * i];
+            uint32_t run = set_lower_bound(s2->items, s2->count, 2, start + 1);
+
+            if (run == 0 || s2->items[2 * (run - 1) + 1] < s1->items[2 * i + 1])
+                return false;
+        }
+
+        return true;
+    }
+
+    bitset_t *b1 = set_bits_view(s1);
+    bitset_t *b2 = set_bits_view(s2);
+    bool is_subseteq = true;
+
+    for (uint32_t i = 0; i < b1->words_count && is_subseteq; i++) {
+        if ((b1->words[i] & ~b2->words[i]) != 0) {
+            is_subseteq = false;
+        }
+    }
+
+    set_bits_release(s1, b1);
+    set_bits_release(s2, b2);
+
+    return is_subseteq;
+}
+
+/**
+ * Checks if the first set is a subset of the second set.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return true if the first set is a subset of the second set, false otherwise.
+ */
+bool set_is_subseteq(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s1 = va_arg(sets, set_t *);
+    set_t *s2 = va_arg(sets, set_t *);
+
+    bool is_subset = _set_is_subseteq(s1, s2);
+
+    va_end(sets);
+
+    return is_subset;
+}
+
+/**
+ * Checks if the first set is a superset of the second set.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return true if the first set is a superset of the second set, false otherwise.
+ */
+bool _set_is_subset(set_t *s1, set_t *s2) {
+    return _set_card(s1) < _set_card(s2) && _set_is_subseteq(s1, s2);
+}
+
+/**
+ * Checks if the first set is a superset of the second set.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return
+ */
+bool set_is_subset(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s1 = va_arg(sets, set_t *);
+    set_t *s2 = va_arg(sets, set_t *);
+
+    bool is_subset = _set_is_subset(s1, s2);
+
+    va_end(sets);
+
+    return is_subset;
+}
+
+/**
+ * Checks if the first set is equal to the second set.
+ * @param s1 The first set.
+ * @param s2 The second set.
+ * @return true if the first set is equal to the second set, false otherwise.
+ */
+bool _set_is_equal(set_t *s1, set_t *s2) {
+    return _set_card(s1) == _set_card(s2) && _set_is_subseteq(s1, s2);
+}
+
+/**
+ * Checks if the first set is equal to the second set.
+ * @param n The number of sets.
+ * @param ... The sets.
+ * @return true if the first set is equal to the second set, false otherwise.
+ */
+bool set_is_equal(int n, ...) {
+    va_list sets;
+    va_start(sets, n);
+
+    set_t *s1 = va_arg(sets, set_t *);
+    set_t *s2 = va_arg(sets, set_t *);
+
+    bool is_equal = _set_is_equal(s1, s2);
+
+    va_end(sets);
+
+    return is_equal;
+}
+
+/**
+ * Physical layout of a relation: the bit matrix of the universe or the
+ * sparse index. Chosen by density of the relation.
+ */
+typedef enum {
+    RELATION_UNPLACED,
+    RELATION_DENSE,
+    RELATION_SPARSE
+} relation_layout_t;
+
+/**
+ * Properties of a relation over the universe.
+ */
+typedef struct {
+    bool reflexive;
+    bool symmetric;
+    bool antisymmetric;
+    bool transitive;
+    bool function;
+} relation_profile_t;
+
+/**
+ * Properties known to hold for a relation without checking, as bits of
+ * relation_set_t.properties. Closures set them on their results, copies
+ * (relation_set_copy) keep them and inverses keep all but function.
+ */
+typedef enum {
+    RELATION_REFLEXIVE = 1 << 0,
+    RELATION_SYMMETRIC = 1 << 1,
+    RELATION_ANTISYMMETRIC = 1 << 2,
+    RELATION_TRANSITIVE = 1 << 3,
+    RELATION_FUNCTION = 1 << 4
+} relation_property_t;
+
+/**
+ * Pair storage of relations, two columns of universe IDs in one block.
+ * Copies of a relation share the storage and count the references, the
+ * relation copies it before its first change while it is shared.
+ */
+typedef struct {
+    int references;
+    uint32_t *elements;
+} relation_storage_t;
+
+/**
+* Definition for relations set. Pairs are stored as two columns of universe
+* IDs in one shared storage, the column b starts right after capacity items of
+* the column a (the other way round for an inverse). Normalized relations have
+* pairs sorted by (a, b) without duplicates and offsets of the pairs of every
+* first element a, as rows of compressed sparse row form. The table is the bit
+* matrix of the relation over the universe and the profile are its properties.
+* Rows and columns are its sparse index, sorted successors and predecessors of
+* every element. All of them are computed on first use and dropped when pairs
+* change. The closure is the bit matrix of the transitive closure, kept by the
+* dense closure and updated in place when pairs are added. Properties are the
+* relation_property_t bits known to hold, they are dropped with the caches.
+*/
+
+typedef struct relation_set {
+    unsigned int index;
+    int size;
+    int capacity;
+    uint32_t *elements_a;
+    uint32_t *elements_b;
+    uint32_t *offsets;
+    uint32_t vertices_count;
+    relation_layout_t layout;
+    unsigned int properties;
+    symbol_table_t *symbols;
+    struct relation_table *table;
+    struct relation_table *closure;
+    relation_profile_t *profile;
+    struct relation_graph *rows;
+    struct relation_graph *columns;
+    relation_storage_t *storage;
+} relation_set_t;
+
+relation_storage_t *relation_storage_init(int capacity);
+
+void relation_storage_release(relation_storage_t *storage);
+
+relation_set_t *relation_set_init(int capacity);
+
+relation_set_t *relation_set_copy(relation_set_t *rv);
+
+relation_set_t *relation_set_inverse(relation_set_t *rv);
+
+unsigned int relation_set_known(relation_set_t *rv);
+
+void relation_set_reserve(relation_set_t *rv, int capacity);
+
+void relation_set_add(relation_set_t *rv, uint32_t element_a,
+                      uint32_t element_b);
+
+void relation_set_append(relation_set_t *rv, const uint32_t *elements_a,
+                         const uint32_t *elements_b, int count);
+
+int relation_set_normalize(relation_set_t *rv, uint32_t vertices_count);
+
+void relation_set_print(relation_set_t *rv);
+
+void relation_set_free(relation_set_t *rv);
+
+void relation_set_invalidate(relation_set_t *rv);
+
+void relation_set_close_pairs(relation_set_t *rv, const uint32_t *elements_a,
+                              const uint32_t *elements_b, int count);
+
+/**
+ * Initializes pair storage with one reference.
+ * @param capacity The number of pairs.
+ * @return The initialized relation_storage_t.
+ */
+relation_storage_t *relation_storage_init(int capacity) {
+    relation_storage_t *storage = malloc(sizeof(relation_storage_t));
+
+    if (storage == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    storage->references = 1;
+    storage->elements = malloc(sizeof(uint32_t) * (2 * capacity + 1));
+
+    if (storage->elements == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    return storage;
+}
+
+/**
+ * Drops one reference of the pair storage, frees it with the last one.
+ * @param storage The relation_storage_t.
+ */
+void relation_storage_release(relation_storage_t *storage) {
+    if (--storage->references > 0)
+        return;
+
+    free(storage->elements);
+    free(storage);
+}
+
+/**
+ * Initializes a relation_set_t.
+ * @param capacity The capacity of the relation_set_t.
+ * @return The initialized relation_set_t.
+ */
+relation_set_t *relation_set_init(int capacity) {
+    relation_set_t *rv = malloc(sizeof(relation_set_t));
+
+    if (rv == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+
+    rv->index = 0;
+    rv->size = 0;
+    rv->capacity = capacity;
+    rv->storage = relation_storage_init(capacity);
+    rv->elements_a = rv->storage->elements;
+    rv->elements_b = rv->elements_a + capacity;
+    rv->offsets = NULL;
+    rv->vertices_count = 0;
+    rv->layout = RELATION_UNPLACED;
+    rv->properties = 0;
+    rv->symbols = NULL;
+
+    rv->table = NULL;
+    rv->closure = NULL;
+    rv->profile = NULL;
+    rv->rows = NULL;
+    rv->columns = NULL;
+
+    return rv;
+}
+
+/**
+ * Copies the relation_set_t. The copy shares the pairs until one of the
+ * relations changes and knows the properties of the relation, it has no
+ * index and no table.
+ * @param rv The relation_set_t.
+ * @return The copy.
+ */
+relation_set_t *relation_set_copy(relation_set_t *rv) {
+    relation_set_t *copy = relation_set_init(0);
+
+    relation_storage_release(copy->storage);
+    copy->storage = rv->storage;
+    copy->storage->references++;
+    copy->size = rv->size;
+    copy->capacity = rv->capacity;
+    copy->elements_a = rv->elements_a;
+    copy->elements_b = rv->elements_b;
+    copy->symbols = rv->symbols;
+    copy->properties = relation_set_known(rv);
+
+    return copy;
+}
+
+/**
+ * Returns the inverse relation. It shares the pairs with the relation and
+ * reads the column a of the relation as its column b and the other way
+ * round, nothing is copied until one of the relations changes.
+ * @param rv The relation_set_t.
+ * @return The inverse relation.
+ */
+relation_set_t *relation_set_inverse(relation_set_t *rv) {
+    relation_set_t *inverse = relation_set_copy(rv);
+
+    inverse->elements_a = rv->elements_b;
+    inverse->elements_b = rv->elements_a;
+
+    /**
+     * All properties but function hold for the inverse too.
+     */
+    inverse->properties &= ~(unsigned int) RELATION_FUNCTION;
+
+    return inverse;
+}
+
+/**
+ * Makes room for at least capacity pairs in storage owned by the relation
+ * only, every change of pairs goes through it. Shared or inverted storage
+ * is copied first. Capacity grows at least x2.
+ * @param rv The relation_set_t.
+ * @param capacity The required capacity.
+ */
+void relation_set_reserve(relation_set_t *rv, int capacity) {
+    relation_storage_t *storage = rv->storage;
+
+    if (capacity < rv->size)
+        capacity = rv->size;
+
+    if (storage->references > 1 || rv->elements_a != storage->elements) {
+        relation_storage_t *own = relation_storage_init(capacity);
+
+        memcpy(own->elements, rv->elements_a, sizeof(uint32_t) * rv->size);
+        memcpy(own->elements + capacity, rv->elements_b,
+               sizeof(uint32_t) * rv->size);
+        relation_storage_release(storage);
+
+        rv->storage = own;
+        rv->capacity = capacity;
+        rv->elements_a = own->elements;
+        rv->elements_b = own->elements + capacity;
+        return;
+    }
+
+    if (capacity <= rv->capacity)
+        return;
+
+    if (capacity < rv->capacity * 2)
+        capacity = rv->capacity * 2;
+
+    storage->elements = realloc(storage->elements,
+                                sizeof(uint32_t) * (2 * capacity + 1));
+
+    if (storage->elements == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Realloc failed");
+
+    rv->elements_a = storage->elements;
+
+    /**
+     * Column b moves to its new start behind the grown column a.
+     */
+    memmove(rv->elements_a + capacity, rv->elements_a + rv->capacity,
+            sizeof(uint32_t) * rv->size);
+
+    rv->capacity = capacity;
+    rv->elements_b = rv->elements_a + capacity;
+}
+
+/**
+ * Adds a pair to the relation_set_t.
+ * @param rv The relation_set_t.
+ * @param element_a The first element.
+ * @param element_b The second element.
+ */
+void relation_set_add(relation_set_t *rv, uint32_t element_a,
+                      uint32_t element_b) {
+    struct relation_table *closure = rv->closure;
+
+    rv->closure = NULL;
+    relation_set_invalidate(rv);
+    relation_set_reserve(rv, rv->size + 1);
+
+    rv->elements_a[rv->size] = element_a;
+    rv->elements_b[rv->size] = element_b;
+    rv->size++;
+
+    rv->closure = closure;
+    relation_set_close_pairs(rv, &element_a, &element_b, 1);
+}
+
+/**
+ * Adds pairs given as two columns to the relation_set_t.
+ * @param rv The relation_set_t.
+ * @param elements_a The first elements.
+ * @param elements_b The second elements.
+ * @param count The number of pairs.
+ */
+void relation_set_append(relation_set_t *rv, const uint32_t *elements_a,
+                         const uint32_t *elements_b, int count) {
+    struct relation_table *closure = rv->closure;
+
+    if (count <= 0)
+        return;
+
+    rv->closure = NULL;
+    relation_set_invalidate(rv);
+    relation_set_reserve(rv, rv->size + count);
+
+    memcpy(rv->elements_a + rv->size, elements_a, sizeof(uint32_t) * count);
+    memcpy(rv->elements_b + rv->size, elements_b, sizeof(uint32_t) * count);
+    rv->size += count;
+
+    rv->closure = closure;
+    relation_set_close_pairs(rv, elements_a, elements_b, count);
+}
+
+/**
+ * Sorts pairs by (a, b) with two stable counting passes, by b and then
+ * by a, removes duplicates and keeps offsets of the rows. Runs in
+ * O(p + n) for p pairs over n elements.
+ * @param rv The relation_set_t.
+ * @param vertices_count The size of the universe, all IDs are below it.
+ * @return The number of removed duplicates.
+ */
+int relation_set_normalize(relation_set_t *rv, uint32_t vertices_count) {
+    uint32_t *counts = calloc(vertices_count + 1, sizeof(uint32_t));
+    uint32_t *offsets = calloc(vertices_count + 1, sizeof(uint32_t));
+    uint32_t *sorted_a = malloc(sizeof(uint32_t) * (2 * rv->size + 1));
+    uint32_t *sorted_b = sorted_a + rv->size;
+    int size = 0;
+
+    if (counts == NULL || offsets == NULL || sorted_a == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    /**
+     * Pairs are sorted in place, shared storage is copied first.
+     */
+    relation_set_reserve(rv, rv->size);
+
+    for (int i = 0; i < rv->size; i++) {
+        if (rv->elements_a[i] >= vertices_count ||
+            rv->elements_b[i] >= vertices_count)
+            print_error(__FILENAME__, __LINE__, __func__,
+                        "Index out of bounds");
+
+        counts[rv->elements_b[i] + 1]++;
+        offsets[rv->elements_a[i] + 1]++;
+    }
+
+    for (uint32_t v = 0; v < vertices_count; v++) {
+        counts[v + 1] += counts[v];
+        offsets[v + 1] += offsets[v];
+    }
+
+    for (int i = 0; i < rv->size; i++) {
+        uint32_t position = counts[rv->elements_b[i]]++;
+
+        sorted_a[position] = rv->elements_a[i];
+        sorted_b[position] = rv->elements_b[i];
+    }
+
+    /**
+     * Counts become the next free position of every row.
+     */
+    memcpy(counts, offsets, sizeof(uint32_t) * (vertices_count + 1));
+
+    for (int i = 0; i < rv->size; i++) {
+        uint32_t position = counts[sorted_a[i]]++;
+
+        rv->elements_a[position] = sorted_a[i];
+        rv->elements_b[position] = sorted_b[i];
+    }
+
+    memset(offsets, 0, sizeof(uint32_t) * (vertices_count + 1));
+
+    for (int i = 0; i < rv->size; i++) {
+        if (size > 0 && rv->elements_a[size - 1] == rv->elements_a[i] &&
+            rv->elements_b[size - 1] == rv->elements_b[i])
+            continue;
+
+        rv->elements_a[size] = rv->elements_a[i];
+        rv->elements_b[size] = rv->elements_b[i];
+        offsets[rv->elements_a[i] + 1]++;
+        size++;
+    }
+
+    for (uint32_t v = 0; v < vertices_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    int duplicates = rv->size - size;
+    struct relation_table *closure = rv->closure;
+    unsigned int properties = rv->properties;
+
+    /**
+     * The set of pairs stays the same, so do its closure and properties.
+     */
+    rv->closure = NULL;
+    relation_set_invalidate(rv);
+    rv->closure = closure;
+    rv->properties = properties;
+    rv->size = size;
+    rv->offsets = offsets;
+    rv->vertices_count = vertices_count;
+
+    free(counts);
+    free(sorted_a);
+
+    return duplicates;
+}
+
+/**
+ * Prints vector of relations.
+ * @param rv The relation_set_t.
+ */
+void relation_set_print(relation_set_t *rv) {
+    for (int i = 0; i < rv->size; i++) {
+        printf("%s %s\n", symbol_table_name(rv->symbols, rv->elements_a[i]),
+               symbol_table_name(rv->symbols, rv->elements_b[i]));
+    }
+}
+
+/**
+ * Frees the memory of the relation_set_t.
+ * @param rv The relation_set_t.
+ */
+void relation_set_free(relation_set_t *rv) {
+    relation_set_invalidate(rv);
+    relation_storage_release(rv->storage);
+    free(rv);
+}
+
+/**
+ * Relation vector definition
+ */
+typedef struct {
+    int size;
+    int capacity;
+    relation_set_t **relations;
+} relation_vector_t;
+
+relation_vector_t *relation_vector_init(int capacity);
+
+void relation_vector_add(relation_vector_t *rv, relation_set_t *s,
+                         unsigned int index);
+
+relation_set_t *relation_vector_find(relation_vector_t *rv, unsigned int index);
+
+void
+relation_vector_add_relation_set(relation_vector_t *rv, relation_set_t *rs);
+
+void relation_vector_print(relation_vector_t *rv);
+
+void relation_vector_free(relation_vector_t *rv);
+
+
+/**
+ * Initializes a relation_vector_t.
+ * @param capacity The capacity of the relation_vector_t.
+ * @return The initialized relation_vector_t.
+ */
+relation_vector_t *relation_vector_init(int capacity) {
+    if (capacity < 0)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid capacity");
+
+    relation_vector_t *rv = malloc(sizeof(relation_vector_t));
+
+    if (rv == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+
+    rv->size = 0;
+    rv->capacity = capacity;
+    rv->relations = malloc(sizeof(relation_set_t *) * capacity);
+
+    return rv;
+}
+
+
+void relation_vector_add(relation_vector_t *rv, relation_set_t *rs,
+                         unsigned int index) {
+    if (rv->size == rv->capacity) {
+        rv->capacity += 1;
+        rv->relations = realloc(rv->relations,
+                                sizeof(relation_set_t *) * rv->capacity);
+    }
+
+    rv->relations[rv->size] = rs;
+    rv->relations[rv->size]->index = rv->relations[rv->size]->index ?
+                                     rv->relations[rv->size]->index : index;
+    rv->size++;
+
+}
+
+relation_set_t *
+relation_vector_find(relation_vector_t *rv, unsigned int index) {
+    for (int i = 0; i < rv->size; i++) {
+        if (rv->relations[i]->index == index) {
+            return rv->relations[i];
+        }
+    }
+
+    return relation_set_init(0);
+}
+
+/**
+ * Adds a new relation to the relation_vector_t.
+ * @param rv The relation_vector_t.
+ * @param rs The relation_set_t.
+ */
+void
+relation_vector_add_relation_set(relation_vector_t *rv, relation_set_t *rs) {
+    if (rv->size == rv->capacity) {
+        rv->capacity += 1;
+        rv->relations = realloc(rv->relations,
+                                sizeof(relation_set_t *) * rv->capacity);
+    }
+
+    rv->relations[rv->size] = rs;
+    rv->size++;
+}
+
+/**
+ * Prints vector of relations.
+ * @param rv The relation_vector_t.
+ */
+void relation_vector_print(relation_vector_t *rv) {
+    for (int i = 0; i < rv->size; i++) {
+        relation_set_print(rv->relations[i]);
+        printf("\n");
+    }
+}
+
+/**
+ * Prints vector of relations.
+ * @param rv The relation_vector_t.
+ */
+void relation_vector_free(relation_vector_t *rv) {
+    for (int i = 0; i < rv->size; i++) {
+        relation_set_free(rv->relations[i]);
+    }
+    free(rv->relations);
+    free(rv);
+}
+
+/**
+ * Cache line size used to align the relation table matrix.
+ */
+#define RELATION_TABLE_ALIGNMENT 64
+
+/**
+ * Tile of the boolean matrix product: rows of the result and 64-bit words
+ * of a row. One tile of the right operand (64 rows of TILE_WORDS words)
+ * and the result tile fit in L1 cache.
+ */
+#define RELATION_TABLE_TILE_ROWS 64
+#define RELATION_TABLE_TILE_WORDS 32
+
+/**
+ * Tables with fewer rows are processed by a single thread.
+ */
+#define RELATION_TABLE_PARALLEL_ROWS 256
+
+/**
+ * Four Russians: a pivot word is split into bytes and every byte gets
+ * a lookup table of all OR combinations of its 8 pivot rows.
+ */
+#define RELATION_TABLE_RUSSIANS_BITS 8
+#define RELATION_TABLE_RUSSIANS_TABLES \
+    (BITSET_WORD_BITS / RELATION_TABLE_RUSSIANS_BITS)
+#define RELATION_TABLE_RUSSIANS_COMBINATIONS (1 << RELATION_TABLE_RUSSIANS_BITS)
+
+/**
+ * Definition for relation table. The matrix is a single contiguous bit
+ * matrix, row i starts at matrix + i * row_words and rows are padded
+ * to whole 64-bit words. The transposed table is built on first use and
+ * owned by the table.
+ */
+typedef struct relation_table {
+    int rows;
+    int columns;
+    uint32_t row_words;
+    set_t *row_items;
+    set_t *column_items;
+    int *row_positions;
+    int *column_positions;
+    uint64_t *matrix;
+    struct relation_table *transposed;
+} relation_table_t;
+
+/**
+ * State of one thread working on a relation table. Rows are partitioned
+ * into contiguous blocks, one per thread.
+ */
+typedef struct {
+    relation_table_t *rt;
+    int thread;
+    int threads_count;
+    pthread_barrier_t *barrier;
+    pthread_mutex_t *lock;
+    void *result;
+} relation_table_worker_t;
+
+/**
+ * Operands of the boolean matrix product computed by the Four Russians
+ * kernel and the lookup tables shared by its threads.
+ */
+typedef struct {
+    relation_table_t *left;
+    relation_table_t *right;
+    uint64_t *combinations;
+} relation_table_product_t;
+
+relation_table_t *relation_table_init(set_t *row_items, set_t *column_items);
+
+relation_table_t *relation_table_init_relation(set_t *row_items,
+                                               set_t *column_items,
+                                               relation_set_t *rv);
+
+relation_table_t *relation_table_copy(relation_table_t *rt);
+
+relation_table_t *relation_table_transpose(relation_table_t *rt);
+
+relation_table_t *relation_table_transposed(relation_table_t *rt);
+
+relation_table_t *relation_set_table(relation_set_t *rv, set_t *universe);
+
+uint64_t *relation_table_row(relation_table_t *rt, int row);
+
+bool relation_table_test(relation_table_t *rt, int row, int column);
+
+void relation_table_set(relation_table_t *rt, int row, int column);
+
+void relation_table_clear(relation_table_t *rt, int row, int column);
+
+int relation_table_row_next(relation_table_t *rt, int row, int from);
+
+int relation_table_row_count(relation_table_t *rt, int row);
+
+void relation_table_add_relation(relation_table_t *rt, uint32_t element_a,
+                                 uint32_t element_b);
+
+void relation_table_remove_relation(relation_table_t *rt, uint32_t element_a,
+                                    uint32_t element_b);
+
+void relation_table_print(relation_table_t *rt);
+
+void relation_table_print_with_names(relation_table_t *rt);
+
+void relation_table_to_relation_set(relation_table_t *rt, relation_set_t *rv);
+
+void relation_table_run(relation_table_t *rt, void *(*kernel)(void *),
+                        void *result);
+
+void relation_table_worker_rows(relation_table_worker_t *w, int *start,
+                                int *end);
+
+void relation_table_close_block(relation_table_t *rt, int k0, int k1);
+
+void relation_table_combinations(relation_table_t *rt, int k,
+                                 uint64_t *combinations);
+
+uint64_t *relation_table_combinations_init(relation_table_t *rt);
+
+void *relation_table_closure_worker(void *arg);
+
+void *relation_table_russians_closure_worker(void *arg);
+
+void *relation_table_russians_product_worker(void *arg);
+
+relation_table_t *relation_table_product(relation_table_t *left,
+                                         relation_table_t *right);
+
+bool relation_table_is_transitive(relation_table_t *rt);
+
+void *relation_table_profile_worker(void *arg);
+
+void relation_table_close_transitive(relation_table_t *rt);
+
+void relation_table_close_cell(relation_table_t *rt, int row, int column);
+
+bool relation_table_close_pair(relation_table_t *rt, uint32_t element_a,
+                               uint32_t element_b);
+
+bool relation_profile_any(relation_profile_t *profile);
+
+void relation_table_profile(relation_table_t *rt, relation_profile_t *profile);
+
+relation_profile_t *relation_set_profile(relation_set_t *rv, set_t *universe);
+
+relation_layout_t relation_set_layout(relation_set_t *rv, set_t *universe);
+
+void relation_set_place(relation_set_t *rv, set_t *universe);
+
+void relation_table_free(relation_table_t *rt);
+
+/**
+ * Initializes a relation_table_t.
+ * @param row_items The set of row items.
+ * @param column_items The set of column items.
+ * @return The initialized relation_table_t.
+ */
+relation_table_t *relation_table_init(set_t *row_items, set_t *column_items) {
+    relation_table_t *rt = malloc(sizeof(relation_table_t));
+    uint32_t symbols_count = row_items->universe_size;
+
+    if (column_items->universe_size > symbols_count)
+        symbols_count = column_items->universe_size;
+
+    if (rt == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    rt->rows = _set_card(row_items);
+    rt->columns = _set_card(column_items);
+    rt->row_words = bitset_words((uint32_t) rt->columns);
+    rt->row_items = row_items;
+    rt->column_items = column_items;
+    rt->transposed = NULL;
+    rt->row_positions = malloc(sizeof(int) * (symbols_count + 1));
+    rt->column_positions = malloc(sizeof(int) * (symbols_count + 1));
+
+    if (rt->row_positions == NULL || rt->column_positions == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    /**
+     * One aligned block for the whole matrix, at least one word so that
+     * empty tables have a valid pointer.
+     */
+    size_t matrix_words = (size_t) rt->rows * rt->row_words;
+    size_t matrix_size = sizeof(uint64_t) * (matrix_words ? matrix_words : 1);
+
+    if (posix_memalign((void **) &rt->matrix, RELATION_TABLE_ALIGNMENT,
+                       matrix_size) != 0)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    memset(rt->matrix, 0, matrix_size);
+
+    /**
+     * Map universe IDs to the table positions.
+     */
+    for (uint32_t i = 0; i < symbols_count; i++) {
+        rt->row_positions[i] = -1;
+        rt->column_positions[i] = -1;
+    }
+
+    set_iterator_t it;
+    int position = 0;
+    for (set_iterator_init(&it, row_items); set_iterator_next(&it);) {
+        rt->row_positions[it.id] = position++;
+    }
+
+    position = 0;
+    for (set_iterator_init(&it, column_items); set_iterator_next(&it);) {
+        rt->column_positions[it.id] = position++;
+    }
+
+    return rt;
+}
+
+/**
+ * Initializes a relation_table_t using relation.
+ * @param row_items The set of row items.
+ * @param column_items The set of column items.
+ * @param rv The relation_set_t.
+ * @return The initialized relation_table_t.
+ */
+relation_table_t *relation_table_init_relation(set_t *row_items,
+                                               set_t *column_items,
+                                               relation_set_t *rv) {
+    relation_table_t *rt = relation_table_init(row_items, column_items);
+
+    for (int i = 0; i < rv->size; i++) {
+        relation_table_add_relation(rt, rv->elements_a[i], rv->elements_b[i]);
+    }
+
+    return rt;
+}
+
+/**
+ * Copies the relation table.
+ * @param rt The relation table.
+ * @return The copy.
+ */
+relation_table_t *relation_table_copy(relation_table_t *rt) {
+    relation_table_t *copy = relation_table_init(rt->row_items,
+                                                 rt->column_items);
+
+    memcpy(copy->matrix, rt->matrix,
+           sizeof(uint64_t) * (size_t) rt->rows * rt->row_words);
+
+    return copy;
+}
+
+/**
+ * Builds the transposed table, rows become columns. The matrix is
+ * transposed by 64 x 64 bit blocks.
+ * @param rt The relation table.
+ * @return The transposed table.
+ */
+relation_table_t *relation_table_transpose(relation_table_t *rt) {
+    relation_table_t *t = relation_table_init(rt->column_items,
+                                              rt->row_items);
+    uint64_t block[BITSET_WORD_BITS];
+
+    for (int ii = 0; ii < rt->rows; ii += BITSET_WORD_BITS) {
+        int rows = rt->rows - ii < BITSET_WORD_BITS
+                   ? rt->rows - ii : BITSET_WORD_BITS;
+
+        for (uint32_t ww = 0; ww < rt->row_words; ww++) {
+            int columns = t->rows - (int) ww * BITSET_WORD_BITS;
+
+            if (columns > BITSET_WORD_BITS)
+                columns = BITSET_WORD_BITS;
+
+            for (int r = 0; r < BITSET_WORD_BITS; r++) {
+                block[r] = r < rows ? relation_table_row(rt, ii + r)[ww] : 0;
+            }
+
+            bit_transpose(block);
+
+            for (int c = 0; c < columns; c++) {
+                relation_table_row(t, (int) ww * BITSET_WORD_BITS + c)
+                        [ii / BITSET_WORD_BITS] = block[c];
+            }
+        }
+    }
+
+    return t;
+}
+
+/**
+ * Returns the transposed table, building it on first use. The table must
+ * not be changed while the transposed one is kept.
+ * @param rt The relation table.
+ * @return The transposed table.
+ */
+relation_table_t *relation_table_transposed(relation_table_t *rt) {
+    if (rt->transposed == NULL)
+        rt->transposed = relation_table_transpose(rt);
+
+    return rt->transposed;
+}
+
+/**
+ * Returns the words of the row.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @return Pointer to the first word of the row.
+ */
+uint64_t *relation_table_row(relation_table_t *rt, int row) {
+    return rt->matrix + (size_t) row * rt->row_words;
+}
+
+/**
+ * Checks if the cell is set.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @param column The column position.
+ * @return True if the cell is set, false otherwise.
+ */
+bool relation_table_test(relation_table_t *rt, int row, int column) {
+    uint64_t *words = relation_table_row(rt, row);
+
+    return (words[column / BITSET_WORD_BITS] >>
+            (column % BITSET_WORD_BITS)) & 1;
+}
+
+/**
+ * Sets the cell.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @param column The column position.
+ */
+void relation_table_set(relation_table_t *rt, int row, int column) {
+    uint64_t *words = relation_table_row(rt, row);
+
+    words[column / BITSET_WORD_BITS] |= 1ULL << (column % BITSET_WORD_BITS);
+}
+
+/**
+ * Clears the cell.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @param column The column position.
+ */
+void relation_table_clear(relation_table_t *rt, int row, int column) {
+    uint64_t *words = relation_table_row(rt, row);
+
+    words[column / BITSET_WORD_BITS] &= ~(1ULL << (column % BITSET_WORD_BITS));
+}
+
+/**
+ * Finds next set cell in the row.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @param from The column position to start from.
+ * @return Column position of the next set cell or columns if there is none.
+ */
+int relation_table_row_next(relation_table_t *rt, int row, int from) {
+    return (int) bit_words_next(relation_table_row(rt, row),
+                                (uint32_t) rt->columns, (uint32_t) from);
+}
+
+/**
+ * Counts set cells in the row.
+ * @param rt The relation table.
+ * @param row The row position.
+ * @return Number of set cells.
+ */
+int relation_table_row_count(relation_table_t *rt, int row) {
+    uint64_t *words = relation_table_row(rt, row);
+    int count = 0;
+
+    for (uint32_t i = 0; i < rt->row_words; i++) {
+        count += bit_popcount(words[i]);
+    }
+
+    return count;
+}
+
+void relation_table_add_relation(relation_table_t *rt, uint32_t element_a,
+                                 uint32_t element_b) {
+    int row_index = rt->row_positions[element_a];
+    int column_index = rt->column_positions[element_b];
+
+    relation_table_set(rt, row_index, column_index);
+}
+
+void relation_table_remove_relation(relation_table_t *rt, uint32_t element_a,
+                                    uint32_t element_b) {
+    int row_index = rt->row_positions[element_a];
+    int column_index = rt->column_positions[element_b];
+
+    relation_table_clear(rt, row_index, column_index);
+}
+
+void relation_table_print(relation_table_t *rt) {
+    for (int i = 0; i < rt->rows; i++) {
+        for (int j = 0; j < rt->columns; j++) {
+            printf("%d ", relation_table_test(rt, i, j));
+        }
+        printf("\n");
+    }
+}
+
+// create a function to print relation table with row and column names
+void relation_table_print_with_names(relation_table_t *rt) {
+    set_t *rows = rt->row_items;
+    set_t *columns = rt->column_items;
+
+    set_iterator_t it;
+
+    printf("R ");
+    for (set_iterator_init(&it, columns); set_iterator_next(&it);) {
+        printf("%s ", symbol_table_name(columns->symbols, it.id));
+    }
+    printf("\n");
+    set_iterator_init(&it, rows);
+    for (int i = 0; i < rt->rows && set_iterator_next(&it); i++) {
+        printf("%s ", symbol_table_name(rows->symbols, it.id));
+        for (int j = 0; j < rt->columns; j++) {
+            printf("%d ", relation_table_test(rt, i, j));
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Replaces pairs of the relation with the set cells of the table.
+ * Pairs are emitted in row-major order.
+ * @param rt The relation table.
+ * @param rv The relation_set_t to fill.
+ */
+void relation_table_to_relation_set(relation_table_t *rt, relation_set_t *rv) {
+    uint32_t *column_ids = malloc(sizeof(uint32_t) * (rt->columns + 1));
+    set_iterator_t it;
+    int size = 0;
+
+    if (column_ids == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    relation_set_invalidate(rv);
+
+    int position = 0;
+    for (set_iterator_init(&it, rt->column_items); set_iterator_next(&it);) {
+        column_ids[position++] = it.id;
+    }
+
+    for (int i = 0; i < rt->rows; i++) {
+        size += relation_table_row_count(rt, i);
+    }
+
+    rv->size = 0;
+    relation_set_reserve(rv, size);
+
+    set_iterator_init(&it, rt->row_items);
+    for (int i = 0; i < rt->rows && set_iterator_next(&it); i++) {
+        for (int j = relation_table_row_next(rt, i, 0); j < rt->columns;
+             j = relation_table_row_next(rt, i, j + 1)) {
+            rv->elements_a[rv->size] = it.id;
+            rv->elements_b[rv->size] = column_ids[j];
+            rv->size++;
+        }
+    }
+
+    free(column_ids);
+}
+
+/**
+ * Runs the kernel on the table using options.threads threads. The calling
+ * thread works as the thread 0. Small tables use a single thread.
+ * @param rt The relation table.
+ * @param kernel The kernel, gets relation_table_worker_t.
+ * @param result Result shared by the threads, may be NULL.
+ */
+void relation_table_run(relation_table_t *rt, void *(*kernel)(void *),
+                        void *result) {
+    int threads_count = options.threads;
+
+    if (rt->rows < RELATION_TABLE_PARALLEL_ROWS)
+        threads_count = 1;
+
+    relation_table_worker_t *workers = malloc(
+            sizeof(relation_table_worker_t) * threads_count);
+    pthread_t *threads = malloc(sizeof(pthread_t) * threads_count);
+    pthread_barrier_t barrier;
+    pthread_mutex_t lock;
+
+    if (workers == NULL || threads == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    if (pthread_barrier_init(&barrier, NULL, (unsigned) threads_count) != 0 ||
+        pthread_mutex_init(&lock, NULL) != 0)
+        print_error(__FILENAME__, __LINE__, __func__,
+                    "Thread synchronization failed");
+
+    for (int t = 0; t < threads_count; t++) {
+        workers[t].rt = rt;
+        workers[t].thread = t;
+        workers[t].threads_count = threads_count;
+        workers[t].barrier = &barrier;
+        workers[t].lock = &lock;
+        workers[t].result = result;
+    }
+
+    for (int t = 1; t < threads_count; t++) {
+        if (pthread_create(&threads[t], NULL, kernel, &workers[t]) != 0)
+            print_error(__FILENAME__, __LINE__, __func__,
+                        "Thread creation failed");
+    }
+
+    kernel(&workers[0]);
+
+    for (int t = 1; t < threads_count; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    pthread_barrier_destroy(&barrier);
+    pthread_mutex_destroy(&lock);
+    free(threads);
+    free(workers);
+}
+
+/**
+ * Returns the block of rows of the thread.
+ * @param w The worker.
+ * @param start Output, the first row.
+ * @param end Output, the row after the last row.
+ */
+void relation_table_worker_rows(relation_table_worker_t *w, int *start,
+                                int *end) {
+    *start = (int) ((int64_t) w->rt->rows * w->thread / w->threads_count);
+    *end = (int) ((int64_t) w->rt->rows * (w->thread + 1) / w->threads_count);
+}
+
+/**
+ * Closes rows of the pivot block over the block with plain Warshall.
+ * @param rt The relation table.
+ * @param k0 The first pivot.
+ * @param k1 The pivot after the last pivot.
+ */
+void relation_table_close_block(relation_table_t *rt, int k0, int k1) {
+    for (int k = k0; k < k1; k++) {
+        uint64_t *row_k = relation_table_row(rt, k);
+
+        for (int i = k0; i < k1; i++) {
+            if (!relation_table_test(rt, i, k))
+                continue;
+
+            uint64_t *row_i = relation_table_row(rt, i);
+
+            for (uint32_t word = 0; word < rt->row_words; word++) {
+                row_i[word] |= row_k[word];
+            }
+        }
+    }
+}
+
+/**
+ * Fills the lookup table of all OR combinations of 8 rows starting with
+ * the row k. Combination c is the combination c without its lowest bit
+ * and one row, so every combination costs one pass over a row. Rows past
+ * the table count as empty.
+ * @param rt The relation table.
+ * @param k The first row.
+ * @param combinations Output, RELATION_TABLE_RUSSIANS_COMBINATIONS rows.
+ */
+void relation_table_combinations(relation_table_t *rt, int k,
+                                 uint64_t *combinations) {
+    memset(combinations, 0, sizeof(uint64_t) * rt->row_words);
+
+    for (uint32_t c = 1; c < RELATION_TABLE_RUSSIANS_COMBINATIONS; c++) {
+        uint64_t *combination = combinations + c * rt->row_words;
+        uint64_t *previous = combinations + (c & (c - 1)) * rt->row_words;
+        int row = k + bit_ctz(c);
+
+        if (row >= rt->rows) {
+            memcpy(combination, previous, sizeof(uint64_t) * rt->row_words);
+            continue;
+        }
+
+        uint64_t *row_k = relation_table_row(rt, row);
+
+        for (uint32_t word = 0; word < rt->row_words; word++) {
+            combination[word] = previous[word] | row_k[word];
+        }
+    }
+}
+
+/**
+ * Allocates lookup tables for one pivot word of the table.
+ * @param rt The relation table.
+ * @return The lookup tables.
+ */
+uint64_t *relation_table_combinations_init(relation_table_t *rt) {
+    uint64_t *combinations;
+
+    if (posix_memalign((void **) &combinations, RELATION_TABLE_ALIGNMENT,
+                       sizeof(uint64_t) * RELATION_TABLE_RUSSIANS_TABLES *
+                       RELATION_TABLE_RUSSIANS_COMBINATIONS *
+                       (rt->row_words + 1)) != 0)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    return combinations;
+}
+
+/**
+ * Blocked Warshall kernel. Pivots are taken by 64 (one word of a row).
+ * The thread 0 first closes rows of the pivot block over the block, then
+ * every thread ORs the pivot rows into its own rows. Threads synchronize
+ * after both phases of every pivot block.
+ * @param arg The relation_table_worker_t.
+ * @return NULL.
+ */
+void *relation_table_closure_worker(void *arg) {
+    relation_table_worker_t *w = arg;
+    relation_table_t *rt = w->rt;
+    int start, end;
+
+    relation_table_worker_rows(w, &start, &end);
+
+    for (uint32_t block = 0; block < rt->row_words; block++) {
+        int k0 = (int) (block * BITSET_WORD_BITS);
+        int k1 = k0 + BITSET_WORD_BITS < rt->rows
+                 ? k0 + BITSET_WORD_BITS : rt->rows;
+
+        if (w->thread == 0)
+            relation_table_close_block(rt, k0, k1);
+
+        pthread_barrier_wait(w->barrier);
+
+        /**
+         * Pivot rows are closed over the block, so ORing the rows of the
+         * pivots found in the row is enough.
+         */
+        for (int i = start; i < end; i++) {
+            if (i >= k0 && i < k1)
+                continue;
+
+            uint64_t *row_i = relation_table_row(rt, i);
+            uint64_t pivots = row_i[block];
+
+            while (pivots != 0) {
+                uint64_t *row_k = relation_table_row(
+                        rt, k0 + bit_ctz(pivots));
+
+                for (uint32_t word = 0; word < rt->row_words; word++) {
+                    row_i[word] |= row_k[word];
+                }
+
+                pivots &= pivots - 1;
+            }
+        }
+
+        pthread_barrier_wait(w->barrier);
     }
 
-    va_end(args);
-    return count;
+    return NULL;
 }
 
 /**
- * Computes the complement of a set.
- * @param s1 The set.
- * @param s2 The set.
- * @return The complement of the set.
+ * Four Russians Warshall kernel. Pivot blocks are closed like in the
+ * bitwise kernel, then the threads fill the lookup tables of the block
+ * and every other row ORs 8 combinations picked by the bytes of its
+ * pivot word instead of one row per set bit.
+ * @param arg The relation_table_worker_t, result is the lookup tables.
+ * @return NULL.
  */
-set_t *_set_complement(set_t *s1, set_t *s2) {
-    return _set_diff(s1, s2);
-}
+void *relation_table_russians_closure_worker(void *arg) {
+    relation_table_worker_t *w = arg;
+    relation_table_t *rt = w->rt;
+    uint64_t *combinations = w->result;
+    size_t table_words = (size_t) RELATION_TABLE_RUSSIANS_COMBINATIONS *
+                         rt->row_words;
+    int start, end;
 
-/**
- * Computes the complement of a set.
- * @param n The number of sets.
- * @param ... The sets.
- * @return The complement of the set.
- */
-set_t *set_complement(int n, ...) {
-    va_list args;
-    va_start(args, n);
+    relation_table_worker_rows(w, &start, &end);
 
-    set_t *s1 = va_arg(args, set_t *);
-    set_t *s2 = va_arg(args, set_t *);
+    for (uint32_t block = 0; block < rt->row_words; block++) {
+        int k0 = (int) (block * BITSET_WORD_BITS);
+        int k1 = k0 + BITSET_WORD_BITS < rt->rows
+                 ? k0 + BITSET_WORD_BITS : rt->rows;
 
-    va_end(args);
-    return _set_complement(s1, s2);
+        if (w->thread == 0)
+            relation_table_close_block(rt, k0, k1);
+
+        pthread_barrier_wait(w->barrier);
+
+        for (int table = w->thread; table < RELATION_TABLE_RUSSIANS_TABLES;
+             table += w->threads_count) {
+            int k = k0 + table * RELATION_TABLE_RUSSIANS_BITS;
+
+            if (k < k1)
+                relation_table_combinations(rt, k,
+                                            combinations + table * table_words);
+        }
+
+        pthread_barrier_wait(w->barrier);
+
+        for (int i = start; i < end; i++) {
+            if (i >= k0 && i < k1)
+                continue;
+
+            uint64_t *row_i = relation_table_row(rt, i);
+            uint64_t pivots = row_i[block];
+
+            for (int table = 0; pivots != 0;
+                 table++, pivots >>= RELATION_TABLE_RUSSIANS_BITS) {
+                uint32_t c = (uint32_t) pivots &
+                             (RELATION_TABLE_RUSSIANS_COMBINATIONS - 1);
+
+                if (c == 0)
+                    continue;
+
+                uint64_t *combination = combinations + table * table_words +
+                                        c * rt->row_words;
+
+                for (uint32_t word = 0; word < rt->row_words; word++) {
+                    row_i[word] |= combination[word];
+                }
+            }
+        }
+
+        pthread_barrier_wait(w->barrier);
+    }
+
+    return NULL;
 }
 
 /**
- * Returns the union of two sets.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return The union of the two sets.
+ * Four Russians product kernel. Rows of the right operand are taken by
+ * 64, the threads fill the lookup tables of the block and every row of
+ * the product ORs 8 combinations picked by the bytes of the matching
+ * word of the left row.
+ * @param arg The relation_table_worker_t, rt is the product and result
+ * the relation_table_product_t.
+ * @return NULL.
  */
-set_t *_set_union(set_t *s1, set_t *s2) {
-    set_t *s = set_init(s1->capacity + s2->capacity);
+void *relation_table_russians_product_worker(void *arg) {
+    relation_table_worker_t *w = arg;
+    relation_table_t *product = w->rt;
+    relation_table_product_t *operands = w->result;
+    relation_table_t *left = operands->left;
+    relation_table_t *right = operands->right;
+    size_t table_words = (size_t) RELATION_TABLE_RUSSIANS_COMBINATIONS *
+                         right->row_words;
+    int start, end;
 
-    for (int i = 0; i < s1->size; i++) {
-        set_add(s, s1->elements[i]);
-    }
+    relation_table_worker_rows(w, &start, &end);
 
-    for (int i = 0; i < s2->size; i++) {
-        bool is_in_set = false;
+    for (uint32_t block = 0; block < left->row_words; block++) {
+        int k0 = (int) (block * BITSET_WORD_BITS);
 
-        for (int j = 0; j < s->size; j++) {
-            if (strcmp(s2->elements[i], s->elements[j]) == 0) {
-                is_in_set = true;
-            }
+        for (int table = w->thread; table < RELATION_TABLE_RUSSIANS_TABLES;
+             table += w->threads_count) {
+            int k = k0 + table * RELATION_TABLE_RUSSIANS_BITS;
+
+            if (k < right->rows)
+                relation_table_combinations(right, k, operands->combinations +
+                                                      table * table_words);
         }
 
-        if (!is_in_set) {
-            set_add(s, s2->elements[i]);
+        pthread_barrier_wait(w->barrier);
+
+        for (int i = start; i < end; i++) {
+            uint64_t *row_product = relation_table_row(product, i);
+            uint64_t middle = relation_table_row(left, i)[block];
+
+            for (int table = 0; middle != 0;
+                 table++, middle >>= RELATION_TABLE_RUSSIANS_BITS) {
+                uint32_t c = (uint32_t) middle &
+                             (RELATION_TABLE_RUSSIANS_COMBINATIONS - 1);
+
+                if (c == 0)
+                    continue;
+
+                uint64_t *combination = operands->combinations +
+                                        table * table_words +
+                                        c * right->row_words;
+
+                for (uint32_t word = 0; word < product->row_words; word++) {
+                    row_product[word] |= combination[word];
+                }
+            }
         }
+
+        pthread_barrier_wait(w->barrier);
     }
 
-    return s;
+    return NULL;
 }
 
 /**
- * Returns the union of sets.
- * @param n The number of sets.
- * @param ... The sets.
- * @return The union of the sets.
+ * Computes the boolean matrix product of the tables with the Four
+ * Russians kernel. Columns of the left table must be rows of the right
+ * one.
+ * @param left The left table.
+ * @param right The right table.
+ * @return The product, rows of the left and columns of the right table.
  */
-set_t *set_union(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+relation_table_t *relation_table_product(relation_table_t *left,
+                                         relation_table_t *right) {
+    relation_table_t *product = relation_table_init(left->row_items,
+                                                    right->column_items);
+    relation_table_product_t operands = {
+            left, right, relation_table_combinations_init(right)
+    };
 
-    set_t *s = set_init(1);
+    if (left->columns != right->rows)
+        print_error(__FILENAME__, __LINE__, __func__,
+                    "Invalid table dimensions");
 
-    for (int i = 0; i < n; i++) {
-        set_t *s_i = va_arg(sets, set_t *);
-        set_t *s_union = _set_union(s, s_i);
-        s = s_union;
-    }
+    relation_table_run(product, relation_table_russians_product_worker,
+                       &operands);
 
-    va_end(sets);
+    free(operands.combinations);
 
-    return s;
+    return product;
 }
 
 /**
- * Returns the intersection of sets.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return The intersection of the sets.
+ * Checks R∘R ⊆ R on the product computed by the Four Russians kernel.
+ * @param rt The square relation table.
+ * @return True if the relation is transitive, false otherwise.
  */
-set_t *_set_intersection(set_t *s1, set_t *s2) {
-    set_t *s = set_init(s1->capacity + s2->capacity);
+bool relation_table_is_transitive(relation_table_t *rt) {
+    relation_table_t *product = relation_table_product(rt, rt);
+    bool transitive = true;
+
+    for (int i = 0; i < rt->rows && transitive; i++) {
+        uint64_t *row_product = relation_table_row(product, i);
+        uint64_t *row = relation_table_row(rt, i);
 
-    for (int i = 0; i < s1->size; i++) {
-        for (int j = 0; j < s2->size; j++) {
-            if (strcmp(s1->elements[i], s2->elements[j]) == 0) {
-                set_add(s, s1->elements[i]);
+        for (uint32_t word = 0; word < rt->row_words; word++) {
+            if ((row_product[word] & ~row[word]) != 0) {
+                transitive = false;
+                break;
             }
         }
     }
 
-    return s;
+    relation_table_free(product);
+
+    return transitive;
 }
 
 /**
- * Returns the intersection of sets.
- * @param n The number of sets.
- * @param ... The sets.
- * @return The intersection of the sets.
+ * Relation profile kernel. Row tiles are dealt to the threads round-robin
+ * and every tile is traversed once: rows give reflexivity and function,
+ * rows compared with rows of the transposed table give symmetry (R = Rᵀ)
+ * and antisymmetry (R ∧ Rᵀ ⊆ I) and pairs (i, j) build the tile of R∘R
+ * which is compared with R as soon as it is complete. Found false flags
+ * are shared between the threads and all threads stop once every flag is
+ * false.
+ * @param arg The relation_table_worker_t.
+ * @return NULL.
  */
-set_t *set_intersection(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+void *relation_table_profile_worker(void *arg) {
+    relation_table_worker_t *w = arg;
+    relation_table_t *rt = w->rt;
+    relation_table_t *transposed = rt->transposed;
+    relation_profile_t *shared = w->result;
+    relation_profile_t local;
+    uint64_t *tile;
 
-    set_t *s = va_arg(sets, set_t *);
+    /**
+     * Properties already decided by the caller are not checked.
+     */
+    pthread_mutex_lock(w->lock);
+    local = *shared;
+    pthread_mutex_unlock(w->lock);
 
-    for (int i = 1; i < n; i++) {
-        set_t *s_i = va_arg(sets, set_t *);
-        set_t *s_intersection = _set_intersection(s, s_i);
-        s = s_intersection;
-    }
+    if (posix_memalign((void **) &tile, RELATION_TABLE_ALIGNMENT,
+                       sizeof(uint64_t) * RELATION_TABLE_TILE_ROWS *
+                       RELATION_TABLE_TILE_WORDS) != 0)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    va_end(sets);
+    for (int ii = w->thread * RELATION_TABLE_TILE_ROWS;
+         ii < rt->rows && relation_profile_any(&local);
+         ii += w->threads_count * RELATION_TABLE_TILE_ROWS) {
+        int rows = rt->rows - ii < RELATION_TABLE_TILE_ROWS
+                   ? rt->rows - ii : RELATION_TABLE_TILE_ROWS;
 
-    return s;
-}
+        for (int i = ii; i < ii + rows; i++) {
+            if (!relation_table_test(rt, i, i))
+                local.reflexive = false;
 
-/**
- * Difference of two sets.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return The difference of the two sets.
- */
-set_t *_set_diff(set_t *s1, set_t *s2) {
-    set_t *s = set_init(s1->capacity + s2->capacity);
+            if (local.function && relation_table_row_count(rt, i) > 1)
+                local.function = false;
+
+            uint64_t *row = relation_table_row(rt, i);
+            uint64_t *row_transposed = relation_table_row(transposed, i);
 
-    for (int i = 0; i < s1->size; i++) {
-        bool is_in_set = false;
+            for (uint32_t word = 0;
+                 word < rt->row_words &&
+                 (local.symmetric || local.antisymmetric); word++) {
+                uint64_t both = row[word] & row_transposed[word];
 
-        for (int j = 0; j < s2->size; j++) {
-            if (strcmp(s1->elements[i], s2->elements[j]) == 0) {
-                is_in_set = true;
+                if (row[word] != row_transposed[word])
+                    local.symmetric = false;
+
+                if (word == (uint32_t) i / BITSET_WORD_BITS)
+                    both &= ~(1ULL << (i % BITSET_WORD_BITS));
+
+                if (both != 0)
+                    local.antisymmetric = false;
             }
         }
 
-        if (!is_in_set) {
-            set_add(s, s1->elements[i]);
+        for (uint32_t ww = 0; ww < rt->row_words && local.transitive;
+             ww += RELATION_TABLE_TILE_WORDS) {
+            uint32_t words = rt->row_words - ww < RELATION_TABLE_TILE_WORDS
+                             ? rt->row_words - ww : RELATION_TABLE_TILE_WORDS;
+
+            memset(tile, 0, sizeof(uint64_t) * RELATION_TABLE_TILE_ROWS *
+                            RELATION_TABLE_TILE_WORDS);
+
+            /**
+             * Middle elements j are taken by 64 so that the rows j stay
+             * in cache.
+             */
+            for (uint32_t kk = 0; kk < rt->row_words; kk++) {
+                for (int i = 0; i < rows; i++) {
+                    uint64_t middle = relation_table_row(rt, ii + i)[kk];
+                    uint64_t *row_product =
+                            tile + i * RELATION_TABLE_TILE_WORDS;
+
+                    while (middle != 0) {
+                        uint64_t *row_j = relation_table_row(
+                                rt, (int) (kk * BITSET_WORD_BITS) +
+                                    bit_ctz(middle)) + ww;
+
+                        for (uint32_t word = 0; word < words; word++) {
+                            row_product[word] |= row_j[word];
+                        }
+
+                        middle &= middle - 1;
+                    }
+                }
+            }
+
+            for (int i = 0; i < rows && local.transitive; i++) {
+                uint64_t *row_product = tile + i * RELATION_TABLE_TILE_WORDS;
+                uint64_t *row_i = relation_table_row(rt, ii + i) + ww;
+
+                for (uint32_t word = 0; word < words; word++) {
+                    if ((row_product[word] & ~row_i[word]) != 0) {
+                        local.transitive = false;
+                        break;
+                    }
+                }
+            }
         }
+
+        pthread_mutex_lock(w->lock);
+        shared->reflexive = local.reflexive =
+                shared->reflexive && local.reflexive;
+        shared->symmetric = local.symmetric =
+                shared->symmetric && local.symmetric;
+        shared->antisymmetric = local.antisymmetric =
+                shared->antisymmetric && local.antisymmetric;
+        shared->transitive = local.transitive =
+                shared->transitive && local.transitive;
+        shared->function = local.function = shared->function && local.function;
+        pthread_mutex_unlock(w->lock);
     }
 
-    return s;
+    free(tile);
+
+    return NULL;
 }
 
 /**
- * Difference of sets.
- * @param n The number of sets.
- * @param ... The sets.
- * @return The difference of the sets.
+ * Computes the transitive closure of the square table in place.
+ * @param rt The relation table.
  */
-set_t *set_diff(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+void relation_table_close_transitive(relation_table_t *rt) {
+    if (rt->transposed != NULL) {
+        relation_table_free(rt->transposed);
+        rt->transposed = NULL;
+    }
 
-    set_t *s = va_arg(sets, set_t *);
+    if (options.algorithm == RELATION_FOUR_RUSSIANS) {
+        uint64_t *combinations = relation_table_combinations_init(rt);
 
-    for (int i = 1; i < n; i++) {
-        set_t *s_i = va_arg(sets, set_t *);
-        set_t *s_diff = _set_diff(s, s_i);
-        s = s_diff;
+        relation_table_run(rt, relation_table_russians_closure_worker,
+                           combinations);
+        free(combinations);
+        return;
     }
 
-    va_end(sets);
-
-    return s;
+    relation_table_run(rt, relation_table_closure_worker, NULL);
 }
 
 /**
- * Checks if the first set is a subset of the second set.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return true if the first set is a subset of the second set, false otherwise.
+ * Sets the cell of the transitive closure in place and keeps it closed:
+ * every row reaching the row element, and the row itself, gets the row of
+ * the column element and the column element. Rows reaching the row are
+ * found by a scan of its column, so the update takes O(n + k * row_words)
+ * for k such rows. The table must be square with the same row and column
+ * items.
+ * @param rt The transitively closed table.
+ * @param row The row of the pair.
+ * @param column The column of the pair.
  */
-bool _set_is_subseteq(set_t *s1, set_t *s2) {
-    for (int i = 0; i < s1->size; i++) {
-        bool is_in_set = false;
+void relation_table_close_cell(relation_table_t *rt, int row, int column) {
+    if (relation_table_test(rt, row, column))
+        return;
 
-        for (int j = 0; j < s2->size; j++) {
-            if (strcmp(s1->elements[i], s2->elements[j]) == 0) {
-                is_in_set = true;
-            }
-        }
+    if (rt->transposed != NULL) {
+        relation_table_free(rt->transposed);
+        rt->transposed = NULL;
+    }
 
-        if (!is_in_set) {
-            return false;
+    /**
+     * Rows reaching a loop reach everything the element reaches already.
+     */
+    if (row == column) {
+        relation_table_set(rt, row, column);
+        return;
+    }
+
+    uint64_t *reach = malloc(sizeof(uint64_t) * (rt->row_words + 1));
+
+    if (reach == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    /**
+     * A copy, the row of the column element changes too when it reaches
+     * the row element.
+     */
+    memcpy(reach, relation_table_row(rt, column),
+           sizeof(uint64_t) * rt->row_words);
+    reach[column / BITSET_WORD_BITS] |= 1ULL << (column % BITSET_WORD_BITS);
+
+    for (int i = 0; i < rt->rows; i++) {
+        if (i != row && !relation_table_test(rt, i, row))
+            continue;
+
+        uint64_t *row_i = relation_table_row(rt, i);
+
+        for (uint32_t word = 0; word < rt->row_words; word++) {
+            row_i[word] |= reach[word];
         }
     }
 
-    return true;
+    free(reach);
 }
 
 /**
- * Checks if the first set is a subset of the second set.
- * @param n The number of sets.
- * @param ... The sets.
- * @return true if the first set is a subset of the second set, false otherwise.
+ * Adds the pair of universe IDs to the transitive closure in place.
+ * @param rt The transitively closed table.
+ * @param element_a The first element.
+ * @param element_b The second element.
+ * @return False if an element is not an item of the table.
  */
-bool set_is_subseteq(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+bool relation_table_close_pair(relation_table_t *rt, uint32_t element_a,
+                               uint32_t element_b) {
+    if (element_a >= rt->row_items->universe_size ||
+        element_b >= rt->column_items->universe_size)
+        return false;
 
-    set_t *s1 = va_arg(sets, set_t *);
-    set_t *s2 = va_arg(sets, set_t *);
+    int row = rt->row_positions[element_a];
+    int column = rt->column_positions[element_b];
 
-    bool is_subset = _set_is_subseteq(s1, s2);
+    if (row < 0 || column < 0)
+        return false;
 
-    va_end(sets);
+    relation_table_close_cell(rt, row, column);
 
-    return is_subset;
+    return true;
 }
 
 /**
- * Checks if the first set is a superset of the second set.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return true if the first set is a superset of the second set, false otherwise.
+ * Checks if any flag of the profile is still true.
+ * @param profile The relation profile.
+ * @return True if any property holds, false otherwise.
  */
-bool _set_is_subset(set_t *s1, set_t *s2) {
-    return _set_is_subseteq(s1, s2) && !_set_is_equal(s1, s2);
+bool relation_profile_any(relation_profile_t *profile) {
+    return profile->reflexive || profile->symmetric ||
+           profile->antisymmetric || profile->transitive || profile->function;
 }
 
 /**
- * Checks if the first set is a superset of the second set.
- * @param n The number of sets.
- * @param ... The sets.
- * @return
+ * Computes all properties of the relation in one traversal of the table,
+ * transitivity with the Four Russians product when it is selected. The
+ * table must be square with the same row and column items.
+ * @param rt The relation table.
+ * @param profile Output, the relation profile.
  */
-bool set_is_subset(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+void relation_table_profile(relation_table_t *rt, relation_profile_t *profile) {
+    profile->reflexive = true;
+    profile->symmetric = true;
+    profile->antisymmetric = true;
+    profile->transitive = true;
+    profile->function = true;
 
-    set_t *s1 = va_arg(sets, set_t *);
-    set_t *s2 = va_arg(sets, set_t *);
+    /**
+     * The Four Russians engine checks transitivity on the whole product,
+     * the profile kernel skips it.
+     */
+    if (options.algorithm == RELATION_FOUR_RUSSIANS)
+        profile->transitive = false;
 
-    bool is_subset = _set_is_subset(s1, s2);
+    relation_table_transposed(rt);
+    relation_table_run(rt, relation_table_profile_worker, profile);
 
-    va_end(sets);
+    if (options.algorithm == RELATION_FOUR_RUSSIANS)
+        profile->transitive = relation_table_is_transitive(rt);
+}
 
-    return is_subset;
+/**
+ * Frees the relation table. Row and column sets are not owned by the table.
+ * @param rt The relation table.
+ */
+void relation_table_free(relation_table_t *rt) {
+    if (rt->transposed != NULL)
+        relation_table_free(rt->transposed);
+
+    free(rt->row_positions);
+    free(rt->column_positions);
+    free(rt->matrix);
+    free(rt);
 }
 
 /**
- * Checks if the first set is equal to the second set.
- * @param s1 The first set.
- * @param s2 The second set.
- * @return true if the first set is equal to the second set, false otherwise.
+ * Returns the table of the relation over the universe, building it on first
+ * use. The table is owned by the relation and must not be changed.
+ * @param rv The relation_set_t.
+ * @param universe The universe.
+ * @return The relation table.
  */
-bool _set_is_equal(set_t *s1, set_t *s2) {
-    if (s1->size != s2->size) {
-        return false;
+relation_table_t *relation_set_table(relation_set_t *rv, set_t *universe) {
+    if (rv->table != NULL && (rv->table->row_items != universe ||
+                              rv->table->column_items != universe))
+        relation_set_invalidate(rv);
+
+    if (rv->table == NULL)
+        rv->table = relation_table_init_relation(universe, universe, rv);
+
+    return rv->table;
+}
+
+/**
+ * Relation graph
+ */
+
+/**
+ * Adjacency of a relation in compressed sparse row form. Successors of
+ * the vertex v are targets[offsets[v]] .. targets[offsets[v + 1] - 1].
+ */
+typedef struct relation_graph {
+    uint32_t vertices_count;
+    uint32_t edges_count;
+    uint32_t *offsets;
+    uint32_t *targets;
+} relation_graph_t;
+
+relation_graph_t *relation_graph_init(relation_set_t *rv,
+                                      uint32_t vertices_count);
+
+uint32_t relation_graph_scc(relation_graph_t *g, uint32_t *components);
+
+relation_graph_t *relation_graph_transpose(relation_graph_t *g);
+
+void relation_graph_free(relation_graph_t *g);
+
+relation_graph_t *relation_set_rows(relation_set_t *rv,
+                                    uint32_t vertices_count);
+
+relation_graph_t *relation_set_columns(relation_set_t *rv,
+                                       uint32_t vertices_count);
+
+/**
+ * Builds adjacency lists of the relation.
+ * @param rv The relation_set_t.
+ * @param vertices_count The size of the universe.
+ * @return The relation graph.
+ */
+relation_graph_t *relation_graph_init(relation_set_t *rv,
+                                      uint32_t vertices_count) {
+    relation_graph_t *g = malloc(sizeof(relation_graph_t));
+
+    if (g == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    g->vertices_count = vertices_count;
+    g->edges_count = (uint32_t) rv->size;
+    g->offsets = calloc(vertices_count + 1, sizeof(uint32_t));
+    g->targets = malloc(sizeof(uint32_t) * (g->edges_count + 1));
+
+    if (g->offsets == NULL || g->targets == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    /**
+     * Normalized relation already has the rows in order.
+     */
+    if (rv->offsets != NULL && rv->vertices_count == vertices_count) {
+        memcpy(g->offsets, rv->offsets,
+               sizeof(uint32_t) * (vertices_count + 1));
+        memcpy(g->targets, rv->elements_b, sizeof(uint32_t) * rv->size);
+
+        return g;
+    }
+
+    /**
+     * Counting sort of the pairs by the first element.
+     */
+    for (int i = 0; i < rv->size; i++) {
+        g->offsets[rv->elements_a[i] + 1]++;
     }
 
-    for (int i = 0; i < s1->size; i++) {
-        bool is_in_set = false;
+    for (uint32_t v = 0; v < vertices_count; v++) {
+        g->offsets[v + 1] += g->offsets[v];
+    }
 
-        for (int j = 0; j < s2->size; j++) {
-            if (strcmp(s1->elements[i], s2->elements[j]) == 0) {
-                is_in_set = true;
-            }
-        }
+    uint32_t *next = malloc(sizeof(uint32_t) * (vertices_count + 1));
+
+    if (next == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    memcpy(next, g->offsets, sizeof(uint32_t) * (vertices_count + 1));
 
-        if (!is_in_set) {
-            return false;
-        }
+    for (int i = 0; i < rv->size; i++) {
+        g->targets[next[rv->elements_a[i]]++] = rv->elements_b[i];
     }
-    return true;
+
+    free(next);
+
+    return g;
 }
 
 /**
- * Checks if the first set is equal to the second set.
- * @param n The number of sets.
- * @param ... The sets.
- * @return true if the first set is equal to the second set, false otherwise.
+ * Finds strongly connected components using iterative Tarjan's algorithm.
+ * Components are numbered in reverse topological order, so every edge
+ * leads from a component to a component with the same or lower number.
+ * @param g The relation graph.
+ * @param components Output, component number of every vertex.
+ * @return Number of components.
  */
-bool set_is_equal(int n, ...) {
-    va_list sets;
-    va_start(sets, n);
+uint32_t relation_graph_scc(relation_graph_t *g, uint32_t *components) {
+    uint32_t n = g->vertices_count;
+    uint32_t *order = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *low = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *edge = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *stack = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *calls = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t stack_size = 0;
+    uint32_t calls_size = 0;
+    uint32_t counter = 0;
+    uint32_t components_count = 0;
 
-    set_t *s1 = va_arg(sets, set_t *);
-    set_t *s2 = va_arg(sets, set_t *);
+    if (order == NULL || low == NULL || edge == NULL || stack == NULL ||
+        calls == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    bool is_equal = _set_is_equal(s1, s2);
+    /**
+     * Components are UINT32_MAX while the vertex is on the stack.
+     */
+    for (uint32_t v = 0; v < n; v++) {
+        order[v] = UINT32_MAX;
+        components[v] = UINT32_MAX;
+    }
 
-    va_end(sets);
+    for (uint32_t root = 0; root < n; root++) {
+        if (order[root] != UINT32_MAX)
+            continue;
 
-    return is_equal;
-}
+        order[root] = low[root] = counter++;
+        edge[root] = g->offsets[root];
+        stack[stack_size++] = root;
+        calls[calls_size++] = root;
 
-/**
- * Definition for relation_t
- */
+        while (calls_size > 0) {
+            uint32_t v = calls[calls_size - 1];
 
-typedef struct {
-    char ***pairs;
-    int count_pairs;
-} relation_t;
+            if (edge[v] < g->offsets[v + 1]) {
+                uint32_t w = g->targets[edge[v]++];
 
-typedef struct {
-    char *element_a;
-    char *element_b;
-} new_relations_t;
+                if (order[w] == UINT32_MAX) {
+                    order[w] = low[w] = counter++;
+                    edge[w] = g->offsets[w];
+                    stack[stack_size++] = w;
+                    calls[calls_size++] = w;
+                } else if (components[w] == UINT32_MAX && order[w] < low[v]) {
+                    low[v] = order[w];
+                }
+                continue;
+            }
 
-new_relations_t *relation_init(char *element_a, char *element_b);
+            calls_size--;
 
-void relation_print(new_relations_t *r);
+            if (low[v] == order[v]) {
+                uint32_t w;
 
-void relation_free(new_relations_t *r);
+                do {
+                    w = stack[--stack_size];
+                    components[w] = components_count;
+                } while (w != v);
 
-new_relations_t *relation_init(char *element_a, char *element_b) {
-    new_relations_t *new_relations = malloc(sizeof(new_relations_t));
+                components_count++;
+            }
 
-    new_relations->element_a = element_a;
-    new_relations->element_b = element_b;
+            if (calls_size > 0) {
+                uint32_t u = calls[calls_size - 1];
 
-    return new_relations;
-}
+                if (low[v] < low[u])
+                    low[u] = low[v];
+            }
+        }
+    }
 
-void relation_print(new_relations_t *r) {
-    if (r == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+    free(order);
+    free(low);
+    free(edge);
+    free(stack);
+    free(calls);
 
-    printf("%s %s\n", r->element_a, r->element_b);
+    return components_count;
 }
 
-void relation_free(new_relations_t *r) {
-    if (r == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+/**
+ * Builds the graph with every edge reversed. Edges are taken by source
+ * vertices in order, so predecessors of every vertex come out sorted.
+ * @param g The relation graph.
+ * @return The transposed graph.
+ */
+relation_graph_t *relation_graph_transpose(relation_graph_t *g) {
+    relation_graph_t *t = malloc(sizeof(relation_graph_t));
 
-    free(r->element_a);
-    free(r->element_b);
-    free(r);
-}
+    if (t == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-/**
-* Definition for relations set
-*/
+    t->vertices_count = g->vertices_count;
+    t->edges_count = g->edges_count;
+    t->offsets = calloc(g->vertices_count + 1, sizeof(uint32_t));
+    t->targets = malloc(sizeof(uint32_t) * (g->edges_count + 1));
 
-typedef struct {
-    unsigned int index;
-    int size;
-    int capacity;
-    new_relations_t **relations;
-} relation_set_t;
+    uint32_t *next = malloc(sizeof(uint32_t) * (g->vertices_count + 1));
 
-relation_set_t *relation_set_init(int capacity);
+    if (t->offsets == NULL || t->targets == NULL || next == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-/**
- * Initializes a relation_set_t.
- * @param capacity The capacity of the relation_set_t.
- * @return The initialized relation_set_t.
- */
-relation_set_t *relation_set_init(int capacity) {
-    relation_set_t *rv = malloc(sizeof(relation_set_t));
+    for (uint32_t e = 0; e < g->edges_count; e++) {
+        t->offsets[g->targets[e] + 1]++;
+    }
 
-    if (rv == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+    for (uint32_t v = 0; v < g->vertices_count; v++) {
+        t->offsets[v + 1] += t->offsets[v];
+    }
 
-    rv->index = 0;
-    rv->size = 0;
-    rv->capacity = capacity;
-    rv->relations = malloc(sizeof(new_relations_t *) * capacity);
+    memcpy(next, t->offsets, sizeof(uint32_t) * (g->vertices_count + 1));
 
-    return rv;
+    for (uint32_t v = 0; v < g->vertices_count; v++) {
+        for (uint32_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+            t->targets[next[g->targets[e]]++] = v;
+        }
+    }
+
+    free(next);
+
+    return t;
 }
 
 /**
- * Adds a new relation to the relation_set_t.
- * @param rv The relation_set_t.
- * @param r The relation_t.
+ * Frees the relation graph.
+ * @param g The relation graph.
  */
-void relation_set_add_relation(relation_set_t *rv, new_relations_t *r) {
-    if (rv->size == rv->capacity) {
-        rv->capacity += 1;
-        rv->relations = realloc(rv->relations,
-                                sizeof(new_relations_t *) * rv->capacity);
-        rv->relations[rv->size] = malloc(sizeof(new_relations_t));
-    }
-
-    rv->relations[rv->size] = r;
-    rv->size++;
+void relation_graph_free(relation_graph_t *g) {
+    free(g->offsets);
+    free(g->targets);
+    free(g);
 }
 
 /**
- * Checks if the relation_set_t is injective.
+ * Drops the cached table, profile, index and row offsets of the relation.
+ * Called on every change of pairs.
  * @param rv The relation_set_t.
- * @param element_a The first element.
- * @param element_b The second element.
  */
-void
-relation_set_add(relation_set_t *rv, char *element_a, char *element_b) {
-    if (rv->size == rv->capacity) {
-        rv->capacity += 1;
-        rv->relations = realloc(rv->relations,
-                                sizeof(new_relations_t *) * rv->capacity);
-    }
+void relation_set_invalidate(relation_set_t *rv) {
+    if (rv->table != NULL)
+        relation_table_free(rv->table);
 
-    new_relations_t *r = malloc(sizeof(new_relations_t));
+    if (rv->closure != NULL)
+        relation_table_free(rv->closure);
 
-    r->element_a = element_a;
-    r->element_b = element_b;
+    if (rv->rows != NULL)
+        relation_graph_free(rv->rows);
 
-    relation_set_add_relation(rv, r);
+    if (rv->columns != NULL)
+        relation_graph_free(rv->columns);
+
+    free(rv->profile);
+    free(rv->offsets);
+    rv->table = NULL;
+    rv->closure = NULL;
+    rv->profile = NULL;
+    rv->rows = NULL;
+    rv->columns = NULL;
+    rv->offsets = NULL;
+    rv->layout = RELATION_UNPLACED;
+    rv->properties = 0;
 }
 
 /**
- * Prints vector of relations.
+ * Returns properties known to hold for the relation: the set ones and
+ * the ones of the computed profile.
  * @param rv The relation_set_t.
+ * @return Bits of relation_property_t.
  */
-void relation_set_print(relation_set_t *rv) {
-    for (int i = 0; i < rv->size; i++) {
-        printf("%s %s\n", rv->relations[i]->element_a,
-               rv->relations[i]->element_b);
-    }
+unsigned int relation_set_known(relation_set_t *rv) {
+    unsigned int known = rv->properties;
+    relation_profile_t *profile = rv->profile;
+
+    if (profile == NULL)
+        return known;
+
+    if (profile->reflexive)
+        known |= RELATION_REFLEXIVE;
+
+    if (profile->symmetric)
+        known |= RELATION_SYMMETRIC;
+
+    if (profile->antisymmetric)
+        known |= RELATION_ANTISYMMETRIC;
+
+    if (profile->transitive)
+        known |= RELATION_TRANSITIVE;
+
+    if (profile->function)
+        known |= RELATION_FUNCTION;
+
+    return known;
 }
 
 /**
- * Frees the memory of the relation_set_t.
+ * Adds pairs to the kept transitive closure of the relation. The closure
+ * is dropped when a pair is not in its universe or when there are more
+ * pairs than rows, computing it again is cheaper then.
  * @param rv The relation_set_t.
+ * @param elements_a The first elements.
+ * @param elements_b The second elements.
+ * @param count The number of pairs.
  */
-void relation_set_free(relation_set_t *rv) {
-    for (int i = 0; i < rv->size; i++) {
-        relation_free(rv->relations[i]);
+void relation_set_close_pairs(relation_set_t *rv, const uint32_t *elements_a,
+                              const uint32_t *elements_b, int count) {
+    if (rv->closure == NULL)
+        return;
+
+    bool kept = count <= rv->closure->rows;
+
+    for (int i = 0; i < count && kept; i++) {
+        kept = relation_table_close_pair(rv->closure, elements_a[i],
+                                         elements_b[i]);
     }
 
-    free(rv->relations);
-    free(rv);
+    if (!kept) {
+        relation_table_free(rv->closure);
+        rv->closure = NULL;
+    }
 }
 
 /**
- * Relation vector definition
+ * Returns the sparse row index of the relation, sorted successors of every
+ * element, building it on first use. Takes O(n + p) memory instead of the
+ * n x n table. The index is owned by the relation and must not be changed.
+ * @param rv The relation_set_t.
+ * @param vertices_count The size of the universe.
+ * @return The row index.
  */
-typedef struct {
-    int size;
-    int capacity;
-    relation_set_t **relations;
-} relation_vector_t;
+relation_graph_t *relation_set_rows(relation_set_t *rv,
+                                    uint32_t vertices_count) {
+    if (rv->rows != NULL && rv->rows->vertices_count != vertices_count)
+        relation_set_invalidate(rv);
 
-relation_vector_t *relation_vector_init(int capacity);
+    if (rv->rows != NULL)
+        return rv->rows;
 
-void relation_vector_add(relation_vector_t *rv, relation_set_t *s,
-                         unsigned int index);
+    relation_graph_t *g = relation_graph_init(rv, vertices_count);
 
-relation_set_t *relation_vector_find(relation_vector_t *rv, unsigned int index);
+    /**
+     * Rows of a normalized relation are sorted already, others are sorted
+     * by transposing twice.
+     */
+    if (rv->offsets != NULL && rv->vertices_count == vertices_count) {
+        rv->rows = g;
+    } else {
+        rv->columns = relation_graph_transpose(g);
+        rv->rows = relation_graph_transpose(rv->columns);
+        relation_graph_free(g);
+    }
 
-void
-relation_vector_add_relation_set(relation_vector_t *rv, relation_set_t *rs);
+    return rv->rows;
+}
 
-void relation_vector_print(relation_vector_t *rv);
+/**
+ * Returns the sparse column index of the relation, sorted predecessors of
+ * every element, building it on first use. The index is owned by the
+ * relation and must not be changed.
+ * @param rv The relation_set_t.
+ * @param vertices_count The size of the universe.
+ * @return The column index.
+ */
+relation_graph_t *relation_set_columns(relation_set_t *rv,
+                                       uint32_t vertices_count) {
+    relation_graph_t *rows = relation_set_rows(rv, vertices_count);
 
-void relation_vector_free(relation_vector_t *rv);
+    if (rv->columns == NULL)
+        rv->columns = relation_graph_transpose(rows);
 
+    return rv->columns;
+}
 
 /**
- * Initializes a relation_vector_t.
- * @param capacity The capacity of the relation_vector_t.
- * @return The initialized relation_vector_t.
+ * Relation pairs
  */
-relation_vector_t *relation_vector_init(int capacity) {
-    if (capacity < 0)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid capacity");
 
-    relation_vector_t *rv = malloc(sizeof(relation_vector_t));
+int relation_pairs_compare(const void *a, const void *b);
 
-    if (rv == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
+uint32_t relation_pairs_find(uint64_t *pairs, uint32_t count, uint64_t pair);
 
-    rv->size = 0;
-    rv->capacity = capacity;
-    rv->relations = malloc(sizeof(relation_set_t *) * capacity);
+bool relation_pairs_includes(uint64_t *inner, uint32_t inner_count,
+                             uint64_t *outer, uint32_t outer_count);
 
-    return rv;
-}
+void relation_pairs_profile(relation_set_t *rv, uint32_t universe_card,
+                            relation_profile_t *profile);
 
+/**
+ * Compares two pairs packed as (a << 32 | b) for qsort.
+ * @param a Pointer to the first pair.
+ * @param b Pointer to the second pair.
+ * @return Negative, zero or positive as for qsort.
+ */
+int relation_pairs_compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
 
-void relation_vector_add(relation_vector_t *rv, relation_set_t *rs,
-                         unsigned int index) {
-    if (rv->size == rv->capacity) {
-        rv->capacity += 1;
-        rv->relations = realloc(rv->relations,
-                                sizeof(relation_set_t *) * rv->capacity);
-    }
+    return (x > y) - (x < y);
+}
 
-    rv->relations[rv->size] = rs;
-    rv->relations[rv->size]->index = rv->relations[rv->size]->index ?
-                                     rv->relations[rv->size]->index : index;
-    rv->size++;
+/**
+ * Finds the first pair not less than the given one by binary search.
+ * @param pairs Sorted packed pairs.
+ * @param count Number of the pairs.
+ * @param pair The packed pair.
+ * @return Index of the first pair not less than the given one.
+ */
+uint32_t relation_pairs_find(uint64_t *pairs, uint32_t count, uint64_t pair) {
+    uint32_t low = 0;
+    uint32_t high = count;
 
-}
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
 
-relation_set_t *
-relation_vector_find(relation_vector_t *rv, unsigned int index) {
-    for (int i = 0; i < rv->size; i++) {
-        if (rv->relations[i]->index == index) {
-            return rv->relations[i];
+        if (pairs[middle] < pair) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
     }
 
-    return relation_set_init(0);
+    return low;
 }
 
 /**
- * Adds a new relation to the relation_vector_t.
- * @param rv The relation_vector_t.
- * @param rs The relation_set_t.
+ * Checks if second elements of one row of sorted pairs are included in
+ * second elements of another row. Every element of the inner row is
+ * looked up by galloping from the position of the previous one, so the
+ * check takes O(k log(m / k)) for rows of k and m pairs and stops on the
+ * first missing element.
+ * @param inner Sorted pairs of the inner row.
+ * @param inner_count Number of the inner pairs.
+ * @param outer Sorted pairs of the outer row.
+ * @param outer_count Number of the outer pairs.
+ * @return True if every element of the inner row is in the outer row.
  */
-void
-relation_vector_add_relation_set(relation_vector_t *rv, relation_set_t *rs) {
-    if (rv->size == rv->capacity) {
-        rv->capacity += 1;
-        rv->relations = realloc(rv->relations,
-                                sizeof(relation_set_t *) * rv->capacity);
+bool relation_pairs_includes(uint64_t *inner, uint32_t inner_count,
+                             uint64_t *outer, uint32_t outer_count) {
+    uint32_t position = 0;
+
+    if (inner_count == 0)
+        return true;
+
+    /**
+     * Rows are sets, a longer row or a row reaching past the other one
+     * cannot be included.
+     */
+    if (inner_count > outer_count ||
+        (uint32_t) inner[0] < (uint32_t) outer[0] ||
+        (uint32_t) inner[inner_count - 1] >
+        (uint32_t) outer[outer_count - 1])
+        return false;
+
+    for (uint32_t i = 0; i < inner_count; i++) {
+        uint32_t element = (uint32_t) inner[i];
+        uint32_t step = 1;
+        uint32_t low = position;
+        uint32_t high;
+
+        if (outer_count - position < inner_count - i)
+            return false;
+
+        while (position + step < outer_count &&
+               (uint32_t) outer[position + step] < element) {
+            low = position + step;
+            step *= 2;
+        }
+
+        high = position + step < outer_count ? position + step : outer_count;
+
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+
+            if ((uint32_t) outer[middle] < element) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        if (low == outer_count || (uint32_t) outer[low] != element)
+            return false;
+
+        position = low + 1;
     }
 
-    rv->relations[rv->size] = rs;
-    rv->size++;
+    return true;
 }
 
 /**
- * Prints vector of relations.
- * @param rv The relation_vector_t.
+ * Computes all properties of the relation on its sorted pairs, without
+ * anything of the size of the universe. Takes O(p log p) for p pairs,
+ * transitivity checks that the row of b is included in the row of a for
+ * every pair (a, b), which takes O(Σ deg²) at most.
+ * @param rv The relation_set_t.
+ * @param universe_card The number of elements of the universe.
+ * @param profile Output, the relation profile.
  */
-void relation_vector_print(relation_vector_t *rv) {
+void relation_pairs_profile(relation_set_t *rv, uint32_t universe_card,
+                            relation_profile_t *profile) {
+    uint32_t count = 0;
+    uint32_t loops = 0;
+    uint64_t *pairs = malloc(sizeof(uint64_t) * (rv->size + 1));
+
+    if (pairs == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
     for (int i = 0; i < rv->size; i++) {
-        relation_set_print(rv->relations[i]);
-        printf("\n");
+        pairs[i] = (uint64_t) rv->elements_a[i] << 32 |
+                   rv->elements_b[i];
     }
-}
 
-/**
- * Prints vector of relations.
- * @param rv The relation_vector_t.
- */
-void relation_vector_free(relation_vector_t *rv) {
+    /**
+     * Pairs of normalized relation are sorted and unique.
+     */
+    if (rv->offsets == NULL)
+        qsort(pairs, rv->size, sizeof(uint64_t), relation_pairs_compare);
+
     for (int i = 0; i < rv->size; i++) {
-        relation_set_free(rv->relations[i]);
+        if (count == 0 || pairs[count - 1] != pairs[i])
+            pairs[count++] = pairs[i];
     }
-    free(rv->relations);
-    free(rv);
-}
 
-/**
- * Definition for relation table
- */
-typedef struct {
-    int rows;
-    int columns;
-    set_t *row_items;
-    set_t *column_items;
-    int **matrix;
-} relation_table_t;
+    profile->symmetric = true;
+    profile->antisymmetric = true;
+    profile->transitive = true;
+    profile->function = true;
 
-relation_table_t *relation_table_init(set_t *row_items, set_t *column_items);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t a = (uint32_t) (pairs[i] >> 32);
+        uint32_t b = (uint32_t) pairs[i];
+        uint64_t inverse = (uint64_t) b << 32 | a;
+        uint32_t found = relation_pairs_find(pairs, count, inverse);
 
-relation_table_t *relation_table_init_relation(set_t *row_items,
-                                               set_t *column_items,
-                                               relation_set_t *rv);
+        if (a == b)
+            loops++;
 
-void relation_table_add_relation(relation_table_t *rt, new_relations_t *r);
+        if (i > 0 && (uint32_t) (pairs[i - 1] >> 32) == a)
+            profile->function = false;
 
-void relation_table_remove_relation(relation_table_t *rt, new_relations_t *r);
+        if (found == count || pairs[found] != inverse) {
+            profile->symmetric = false;
+        } else if (a != b) {
+            profile->antisymmetric = false;
+        }
+    }
 
-void relation_table_print(relation_table_t *rt);
+    profile->reflexive = loops == universe_card;
 
-void relation_table_print_with_names(relation_table_t *rt);
+    for (uint32_t row = 0, row_end; row < count && profile->transitive;
+         row = row_end) {
+        uint64_t a = pairs[row] >> 32;
 
-/**
- * Initializes a relation_table_t.
- * @param row_items The set of row items.
- * @param column_items The set of column items.
- * @return The initialized relation_table_t.
- */
-relation_table_t *relation_table_init(set_t *row_items, set_t *column_items) {
-    relation_table_t *rt = malloc(sizeof(relation_table_t));
+        for (row_end = row; row_end < count && pairs[row_end] >> 32 == a;) {
+            row_end++;
+        }
 
-    rt->rows = row_items->size;
-    rt->columns = column_items->size;
-    rt->row_items = row_items;
-    rt->column_items = column_items;
-    rt->matrix = malloc(sizeof(int *) * rt->rows);
+        for (uint32_t i = row; i < row_end; i++) {
+            uint64_t b = (uint32_t) pairs[i];
 
-    for (int i = 0; i < rt->rows; i++) {
-        rt->matrix[i] = malloc(sizeof(int) * rt->columns);
+            if (b == a)
+                continue;
 
-        for (int j = 0; j < rt->columns; j++) {
-            rt->matrix[i][j] = 0;
+            uint32_t start = relation_pairs_find(pairs, count, b << 32);
+            uint32_t end = relation_pairs_find(pairs, count, (b + 1) << 32);
+
+            if (!relation_pairs_includes(pairs + start, end - start,
+                                         pairs + row, row_end - row)) {
+                profile->transitive = false;
+                break;
+            }
         }
     }
 
-    return rt;
+    free(pairs);
 }
 
 /**
- * Initializes a relation_table_t using relation.
- * @param row_items The set of row items.
- * @param column_items The set of column items.
+ * Returns properties of the relation over the universe, computing them on
+ * first use. Every later property query of the relation reuses them.
  * @param rv The relation_set_t.
- * @return The initialized relation_table_t.
+ * @param universe The universe.
+ * @return The relation profile.
  */
-relation_table_t *relation_table_init_relation(set_t *row_items,
-                                               set_t *column_items,
-                                               relation_set_t *rv) {
-    relation_table_t *rt = relation_table_init(row_items, column_items);
+relation_profile_t *relation_set_profile(relation_set_t *rv, set_t *universe) {
+    if (rv->table != NULL && rv->table->row_items != universe)
+        relation_set_invalidate(rv);
 
-    for (int i = 0; i < rv->size; i++) {
-        new_relations_t *r = rv->relations[i];
+    if (rv->profile != NULL)
+        return rv->profile;
 
-        int row_index = set_item_index(rt->row_items, r->element_a);
-        int column_index = set_item_index(rt->column_items, r->element_b);
+    rv->profile = malloc(sizeof(relation_profile_t));
 
-        rt->matrix[row_index][column_index] = 1;
-    }
+    if (rv->profile == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    return rt;
-}
+    counters.profiles++;
 
-void relation_table_add_relation(relation_table_t *rt, new_relations_t *r) {
-    int row_index = set_item_index(rt->row_items, r->element_a);
-    int column_index = set_item_index(rt->column_items, r->element_b);
+    /**
+     * Sparse relations are checked on their pairs, the table of the
+     * universe would be mostly empty.
+     */
+    if (relation_set_layout(rv, universe) == RELATION_SPARSE) {
+        relation_pairs_profile(rv, (uint32_t) _set_card(universe),
+                               rv->profile);
+    } else {
+        relation_table_profile(relation_set_table(rv, universe), rv->profile);
+    }
 
-    rt->matrix[row_index][column_index] = 1;
+    return rv->profile;
 }
 
-void relation_table_remove_relation(relation_table_t *rt, new_relations_t *r) {
-    int row_index = set_item_index(rt->row_items, r->element_a);
-    int column_index = set_item_index(rt->column_items, r->element_b);
+/**
+ * Returns the layout of the relation, choosing it on first use. Relations
+ * with less than 1 / options.sparse_density of all pairs of the universe
+ * are sparse.
+ * @param rv The relation_set_t.
+ * @param universe The universe.
+ * @return The layout.
+ */
+relation_layout_t relation_set_layout(relation_set_t *rv, set_t *universe) {
+    uint64_t cells = (uint64_t) universe->universe_size *
+                     universe->universe_size;
 
-    rt->matrix[row_index][column_index] = 0;
-}
+    if (rv->layout == RELATION_UNPLACED)
+        rv->layout = (uint64_t) rv->size * options.sparse_density < cells
+                     ? RELATION_SPARSE : RELATION_DENSE;
 
-void relation_table_print(relation_table_t *rt) {
-    for (int i = 0; i < rt->rows; i++) {
-        for (int j = 0; j < rt->columns; j++) {
-            printf("%d ", rt->matrix[i][j]);
-        }
-        printf("\n");
-    }
+    return rv->layout;
 }
 
-// create a function to print relation table with row and column names
-void relation_table_print_with_names(relation_table_t *rt) {
-    printf("R ");
-    for (int i = 0; i < rt->columns; i++) {
-        if (i < rt->columns) {
-            printf("%s ", rt->column_items->elements[i]);
-        }
-    }
-    printf("\n");
-    for (int i = 0; i < rt->rows; i++) {
-        printf("%s ", rt->row_items->elements[i]);
-        for (int j = 0; j < rt->columns; j++) {
-            printf("%d ", rt->matrix[i][j]);
-        }
-        printf("\n");
+/**
+ * Chooses the layout of the relation and builds it: the table for dense
+ * relations, the row index for sparse ones.
+ * @param rv The relation_set_t.
+ * @param universe The universe.
+ */
+void relation_set_place(relation_set_t *rv, set_t *universe) {
+    if (relation_set_layout(rv, universe) == RELATION_DENSE) {
+        relation_set_table(rv, universe);
+    } else {
+        relation_set_rows(rv, universe->universe_size);
     }
 }
 
@@ -1534,8 +4721,6 @@ void relation_table_print_with_names(relation_table_t *rt) {
  * Relation math
  */
 
-void rel_table(int **table, relation_t *rel_arr, set_t *univerzum);
-
 bool _relation_is_reflexive(relation_set_t *rv, set_t *universe);
 
 bool relation_is_reflexive(int n, ...);
@@ -1564,6 +4749,9 @@ set_t *_relation_codomain(relation_set_t *rv, set_t *universe);
 
 set_t *relation_codomain(int n, ...);
 
+void _relation_mapping(relation_set_t *rv, set_t *s1, set_t *s2,
+                       bool *is_injective, bool *is_surjective);
+
 bool _relation_is_injective(relation_set_t *rv, set_t *s1, set_t *s2);
 
 bool relation_is_injective(int n, ...);
@@ -1580,39 +4768,35 @@ relation_set_t *_closure_ref(relation_set_t *rv, set_t *universe);
 
 relation_set_t *closure_ref(int n, ...);
 
+relation_set_t *_closure_sym_dense(relation_set_t *rv, set_t *universe);
+
+relation_set_t *_closure_sym_sparse(relation_set_t *rv, set_t *universe);
+
 relation_set_t *_closure_sym(relation_set_t *rv, set_t *universe);
 
 relation_set_t *closure_sym(int n, ...);
 
+relation_set_t *_closure_trans_dense(relation_set_t *rv, set_t *universe);
+
+relation_set_t *_closure_trans_sparse(relation_set_t *rv, set_t *universe);
+
 relation_set_t *_closure_trans(relation_set_t *rv, set_t *universe);
 
 relation_set_t *closure_trans(int n, ...);
 
+uint32_t relation_search_expand(relation_graph_t *g, uint32_t *queue,
+                                uint32_t start, uint32_t end, uint32_t tail,
+                                bitset_t *own, bitset_t *other,
+                                bool *met);
 
-/**
- * table of 0 and 1 for relation_t
- */
-void rel_table(int **table, relation_t *rel_arr, set_t *universe) {
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            table[i][j] = 0;
-        }
-    }
-    for (int i = 0; i < rel_arr->count_pairs; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            if (strcmp(rel_arr->pairs[i][0], universe->elements[j]) == 0) {
-                for (int k = 0; k < universe->size; k++) {
-                    if (strcmp(rel_arr->pairs[i][1], universe->elements[k]) ==
-                        0) {
-                        table[j][k] = 1;
-                        break;
-                    }
-                }
-                break;
-            }
-        }
-    }
-}
+void _relation_reachable(relation_set_t *rv, uint32_t *sources,
+                         uint32_t *targets, int count, bool *results,
+                         set_t *universe);
+
+bool _relation_reaches(relation_set_t *rv, uint32_t source, uint32_t target,
+                       set_t *universe);
+
+void relation_reachable(int n, ...);
 
 /**
  * Checks if the relation is reflexive.
@@ -1621,19 +4805,12 @@ void rel_table(int **table, relation_t *rel_arr, set_t *universe) {
  * @return true if the relation is reflexive, false otherwise.
  */
 bool _relation_is_reflexive(relation_set_t *rv, set_t *universe) {
-    if (universe->size == 0 && rv->size == 0) {
+    if (rv->properties & RELATION_REFLEXIVE) {
+        counters.known++;
         return true;
     }
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
-
-    for (int i = 0; i < universe->size; i++) {
-        if (rt->matrix[i][i] != 1) {
-            return false;
-        }
-    }
 
-    return true;
+    return relation_set_profile(rv, universe)->reflexive;
 }
 
 /**
@@ -1663,21 +4840,12 @@ bool relation_is_reflexive(int n, ...) {
  * @return true if the relation is symmetric, false otherwise.
  */
 bool _relation_is_symmetric(relation_set_t *rv, set_t *universe) {
-    if (universe->size == 0 && rv->size == 0) {
+    if (rv->properties & RELATION_SYMMETRIC) {
+        counters.known++;
         return true;
     }
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
 
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            if (rt->matrix[i][j] == 1 && rt->matrix[j][i] == 0) {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    return relation_set_profile(rv, universe)->symmetric;
 }
 
 /**
@@ -1707,21 +4875,12 @@ bool relation_is_symmetric(int n, ...) {
  * @return true if the relation is antisymmetric, false otherwise.
  */
 bool _relation_is_antisymmetric(relation_set_t *rv, set_t *universe) {
-    if (universe->size == 0 && rv->size == 0) {
+    if (rv->properties & RELATION_ANTISYMMETRIC) {
+        counters.known++;
         return true;
     }
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
-
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            if (rt->matrix[i][j] == 1 && rt->matrix[j][i] == 1 && i != j) {
-                return false;
-            }
-        }
-    }
 
-    return true;
+    return relation_set_profile(rv, universe)->antisymmetric;
 }
 
 /**
@@ -1730,14 +4889,259 @@ bool _relation_is_antisymmetric(relation_set_t *rv, set_t *universe) {
  * @param ... The rows of relation_t and universe.
  * @return True if the relation is antisymmetric, false otherwise.
  */
-bool relation_is_antisymmetric(int n, ...) {
+bool relation_is_antisymmetric(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    relation_set_t *rv = va_arg(args, relation_set_t *);
+    set_t *universe = va_arg(args, set_t *);
+
+    bool result = _relation_is_antisymmetric(rv, universe);
+
+    va_end(args);
+
+    return result;
+}
+
+/**
+ * Checks if the relation is transitive.
+ * @param rel_arr The array of relation pairs.
+ * @param universe The universe.
+ * @return true if the relation is transitive, false otherwise.
+ */
+bool _relation_is_transitive(relation_set_t *rv, set_t *universe) {
+    if (rv->properties & RELATION_TRANSITIVE) {
+        counters.known++;
+        return true;
+    }
+
+    return relation_set_profile(rv, universe)->transitive;
+}
+
+/**
+ * Checks if the relation is transitive.
+ * @param n The number of relation_t.
+ * @param ... The rows of relation_t and universe.
+ * @return True if the relation is transitive, false otherwise.
+ */
+bool relation_is_transitive(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    relation_set_t *rv = va_arg(args, relation_set_t *);
+    set_t *universe = va_arg(args, set_t *);
+
+    bool result = _relation_is_transitive(rv, universe);
+
+    va_end(args);
+
+    return result;
+}
+
+/**
+ * Checks if the relation is function.
+ * @param rel_arr The array of relation pairs.
+ * @param universe The universe.
+ * @return true if the relation is function, false otherwise.
+ */
+bool _relation_is_function(relation_set_t *rv, set_t *universe) {
+    if (rv->properties & RELATION_FUNCTION) {
+        counters.known++;
+        return true;
+    }
+
+    return relation_set_profile(rv, universe)->function;
+}
+/**
+ * Checks if the relation is a function.
+ * @param n The number of relation_t.
+ * @param ... The rows of relation_t and universe.
+ * @return True if the relation is a function, false otherwise.
+ */
+bool relation_is_function(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    relation_set_t *rv = va_arg(args, relation_set_t *);
+    set_t *universe = va_arg(args, set_t *);
+
+    bool result = _relation_is_function(rv, universe);
+
+    va_end(args);
+
+    return result;
+}
+
+/**
+ * Finds domain of the relation
+ * @param rel_arr The array of relation pairs.
+ * @param universe The universe.
+ */
+set_t *_relation_domain(relation_set_t *rv, set_t *universe) {
+    set_t *domain = set_init((int) universe->universe_size);
+    domain->symbols = universe->symbols;
+
+    /**
+     * Elements are collected in a bitset, which emits them ordered.
+     */
+    set_convert(domain, SET_BITSET);
+
+    for (int i = 0; i < rv->size; i++) {
+        bitset_set(domain->bits, rv->elements_a[i]);
+    }
+
+    set_optimize(domain);
+
+    return domain;
+}
+
+/**
+ * Finds domain of the relation_t.
+ * @param n The number of relation_t.
+ * @param ... The rows of relation_t and universe.
+ */
+set_t *relation_domain(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    relation_set_t *rv = va_arg(args, relation_set_t *);
+    set_t *universe = va_arg(args, set_t *);
+
+    set_t *result = _relation_domain(rv, universe);
+    va_end(args);
+
+    return result;
+}
+
+/**
+ * Finds codomain of the relation
+ * @param rel_arr The array of relation pairs.
+ * @param universe The universe.
+ */
+set_t *_relation_codomain(relation_set_t *rv, set_t *universe) {
+    set_t *codomain = set_init((int) universe->universe_size);
+    codomain->symbols = universe->symbols;
+
+    /**
+     * Elements are collected in a bitset, which emits them ordered.
+     */
+    set_convert(codomain, SET_BITSET);
+
+    for (int i = 0; i < rv->size; i++) {
+        bitset_set(codomain->bits, rv->elements_b[i]);
+    }
+
+    set_optimize(codomain);
+
+    return codomain;
+}
+
+/**
+ * Finds codomain of the relation_t.
+ * @param n The number of relation_t.
+ * @param ... The rows of relation_t and universe.
+ */
+set_t *relation_codomain(int n, ...) {
+    va_list args;
+    va_start(args, n);
+
+    relation_set_t *rv = va_arg(args, relation_set_t *);
+    set_t *universe = va_arg(args, set_t *);
+
+    set_t *result = _relation_codomain(rv, universe);
+    va_end(args);
+
+    return result;
+}
+
+/**
+ * Checks the relation as a mapping from s1 to s2. Out-degree and in-degree
+ * of every element are read from the sparse index of the relation, which
+ * is shared by all three checks. Both injective and surjective relation
+ * must be a function defined on all of s1 with values in s2.
+ * @param rv The relation
+ * @param s1 The first set (domain)
+ * @param s2 The second set (codomain)
+ * @param is_injective Output, true if no element of s2 is hit twice.
+ * @param is_surjective Output, true if every element of s2 is hit.
+ */
+void _relation_mapping(relation_set_t *rv, set_t *s1, set_t *s2,
+                       bool *is_injective, bool *is_surjective) {
+    uint32_t ids = s1->universe_size > s2->universe_size
+                   ? s1->universe_size : s2->universe_size;
+    bool is_function = true;
+    bool is_unique = true;
+    bool is_covering = true;
+    set_iterator_t it;
+
+    for (int i = 0; i < rv->size && is_function; i++) {
+        if (!set_contains(s1, rv->elements_a[i]) ||
+            !set_contains(s2, rv->elements_b[i]))
+            is_function = false;
+    }
+
+    if (!is_function) {
+        *is_injective = false;
+        *is_surjective = false;
+        return;
+    }
+
+    relation_graph_t *rows = relation_set_rows(rv, ids);
+    relation_graph_t *columns = relation_set_columns(rv, ids);
+
+    /**
+     * Every element of s1 has exactly one image.
+     */
+    for (set_iterator_init(&it, s1); set_iterator_next(&it) && is_function;) {
+        if (rows->offsets[it.id + 1] - rows->offsets[it.id] != 1)
+            is_function = false;
+    }
+
+    for (set_iterator_init(&it, s2); set_iterator_next(&it);) {
+        uint32_t degree = columns->offsets[it.id + 1] - columns->offsets[it.id];
+
+        if (degree > 1)
+            is_unique = false;
+
+        if (degree == 0)
+            is_covering = false;
+    }
+
+    *is_injective = is_function && is_unique;
+    *is_surjective = is_function && is_covering;
+}
+
+/**
+ * Checks if the relation is injective.
+ * @param rel_arr The relation
+ * @param s1 The first set (domain)
+ * @param s2 The second set (codomain)
+ * @return True if the relation is injective, false otherwise.
+ */
+bool _relation_is_injective(relation_set_t *rv, set_t *s1, set_t *s2) {
+    bool is_injective;
+    bool is_surjective;
+
+    _relation_mapping(rv, s1, s2, &is_injective, &is_surjective);
+
+    return is_injective;
+}
+
+/**
+ * Checks if the relation is injective.
+ * @param n The number of relation_t.
+ * @param ... The rows of relation_t and sets.
+ * @return True if the relation is injective, false otherwise.
+ */
+bool relation_is_injective(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t *);
+    set_t *s1 = va_arg(args, set_t *);
+    set_t *s2 = va_arg(args, set_t *);
 
-    bool result = _relation_is_antisymmetric(rv, universe);
+    bool result = _relation_is_injective(rv, s1, s2);
 
     va_end(args);
 
@@ -1745,46 +5149,36 @@ bool relation_is_antisymmetric(int n, ...) {
 }
 
 /**
- * Checks if the relation is transitive.
- * @param rel_arr The array of relation pairs.
- * @param universe The universe.
- * @return true if the relation is transitive, false otherwise.
+ * Checks if the relation is surjective.
+ * @param rel_arr The relation
+ * @param s1 The first set (domain)
+ * @param s2 The second set (codomain)
+ * @return True if the relation is surjective, false otherwise.
  */
-bool _relation_is_transitive(relation_set_t *rv, set_t *universe) {
-    if (universe->size == 0 && rv->size == 0) {
-        return true;
-    }
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
+bool _relation_is_surjective(relation_set_t *rv, set_t *s1, set_t *s2) {
+    bool is_injective;
+    bool is_surjective;
 
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            for (int k = 0; k < universe->size; k++) {
-                if (rt->matrix[i][j] == 1 && rt->matrix[j][k] == 1 &&
-                    rt->matrix[i][k] == 0) {
-                    return false;
-                }
-            }
-        }
-    }
+    _relation_mapping(rv, s1, s2, &is_injective, &is_surjective);
 
-    return true;
+    return is_surjective;
 }
 
 /**
- * Checks if the relation is transitive.
+ * Checks if the relation is surjective.
  * @param n The number of relation_t.
- * @param ... The rows of relation_t and universe.
- * @return True if the relation is transitive, false otherwise.
+ * @param ... The rows of relation_t and sets.
+ * @return True if the relation is surjective, false otherwise.
  */
-bool relation_is_transitive(int n, ...) {
+bool relation_is_surjective(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t *);
+    set_t *s1 = va_arg(args, set_t *);
+    set_t *s2 = va_arg(args, set_t *);
 
-    bool result = _relation_is_transitive(rv, universe);
+    bool result = _relation_is_surjective(rv, s1, s2);
 
     va_end(args);
 
@@ -1792,46 +5186,36 @@ bool relation_is_transitive(int n, ...) {
 }
 
 /**
- * Checks if the relation is function.
- * @param rel_arr The array of relation pairs.
- * @param universe The universe.
- * @return true if the relation is function, false otherwise.
+ * Checks if the relation is bijective.
+ * @param rel_arr The relation
+ * @param s1 The first set (domain)
+ * @param s2 The second set (codomain)
+ * @return True if the relation is bijective, false otherwise.
  */
-bool _relation_is_function(relation_set_t *rv, set_t *universe) {
-    if (universe->size == 0 && rv->size == 0) {
-        return true;
-    }
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
+bool _relation_is_bijective(relation_set_t *rv, set_t *s1, set_t *s2) {
+    bool is_injective;
+    bool is_surjective;
 
-    for (int i = 0; i < universe->size; i++) {
-        int total_in_row = 0;
-        for (int j = 0; j < universe->size; j++) {
-            if (rt->matrix[i][j] == 1) {
-                total_in_row++;
-            }
-            if (total_in_row == 2) {
-                return false;
-            }
-        }
-    }
+    _relation_mapping(rv, s1, s2, &is_injective, &is_surjective);
 
-    return true;
+    return is_injective && is_surjective;
 }
+
 /**
- * Checks if the relation is a function.
+ * Checks if the relation is bijective.
  * @param n The number of relation_t.
- * @param ... The rows of relation_t and universe.
- * @return True if the relation is a function, false otherwise.
+ * @param ... The rows of relation_t and sets.
+ * @return True if the relation is bijective, false otherwise.
  */
-bool relation_is_function(int n, ...) {
+bool relation_is_bijective(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t *);
+    set_t *s1 = va_arg(args, set_t *);
+    set_t *s2 = va_arg(args, set_t *);
 
-    bool result = _relation_is_function(rv, universe);
+    bool result = _relation_is_bijective(rv, s1, s2);
 
     va_end(args);
 
@@ -1839,393 +5223,601 @@ bool relation_is_function(int n, ...) {
 }
 
 /**
- * Finds domain of the relation
- * @param rel_arr The array of relation pairs.
+ * Finds the reflexive closure of the relation, for sparse and dense
+ * relations alike. Pairs (a, a) are marked in a bitset over the universe,
+ * the unmarked diagonal is appended to a copy of the relation in one block
+ * and normalized, so the result is sorted by (a, b). Runs in O(p + |U|).
+ * A kept transitive closure is copied to the result and updated by the
+ * diagonal. Relations known to be reflexive are returned as a copy sharing
+ * the pairs.
+ * @param rv The relation set.
  * @param universe The universe.
+ * @return The reflexive closure of the relation as a new relation set.
  */
-set_t *_relation_domain(relation_set_t *rv, set_t *universe) {
-    set_t *domain = set_init(0);
+relation_set_t *_closure_ref(relation_set_t *rv, set_t *universe) {
+    unsigned int known = relation_set_known(rv);
+
+    /**
+     * A relation known to be reflexive is its own closure, the result
+     * shares its pairs.
+     */
+    if (known & RELATION_REFLEXIVE)
+        return relation_set_copy(rv);
+
+    uint32_t n = universe->universe_size;
+    relation_set_t *closure = relation_set_copy(rv);
+    bitset_t *diagonal = bitset_init(n);
+    uint32_t *missing = malloc(sizeof(uint32_t) * (_set_card(universe) + 1));
+    int count = 0;
+    set_iterator_t it;
+
+    if (missing == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    if (rv->closure != NULL && rv->closure->row_items == universe)
+        closure->closure = relation_table_copy(rv->closure);
 
     for (int i = 0; i < rv->size; i++) {
-        int flag = 0;
-        for (int j = 0; j < universe->size; j++) {
-            if (strcmp(rv->relations[i]->element_a, universe->elements[j]) ==
-                0) {
-                for (int k = 0; k < domain->size; k++) {
-                    if (strcmp(rv->relations[i]->element_a,
-                               domain->elements[k]) == 0) {
-                        flag = 1;
-                        break;
-                    }
-                }
-                if (flag == 0) {
-                    set_add(domain, rv->relations[i]->element_a);
-                }
-                break;
-            }
-        }
+        if (rv->elements_a[i] == rv->elements_b[i])
+            bitset_set(diagonal, rv->elements_a[i]);
     }
 
-    return domain;
+    set_iterator_init(&it, universe);
+
+    while (set_iterator_next(&it)) {
+        if (!bitset_test(diagonal, it.id))
+            missing[count++] = it.id;
+    }
+
+    relation_set_append(closure, missing, missing, count);
+    relation_set_normalize(closure, n);
+
+    free(missing);
+    bitset_free(diagonal);
+
+    /**
+     * The diagonal keeps symmetry, antisymmetry and transitivity.
+     */
+    closure->properties = RELATION_REFLEXIVE |
+                          (known & (RELATION_SYMMETRIC |
+                                    RELATION_ANTISYMMETRIC |
+                                    RELATION_TRANSITIVE));
+
+    return closure;
 }
 
 /**
- * Finds domain of the relation_t.
- * @param n The number of relation_t.
- * @param ... The rows of relation_t and universe.
+ * Finds the reflexive closure of the relation.
+ * @param n The number of arguments.
+ * @param ... The set of relation and the universe.
+ * @return the reflexive closure of the relation.
  */
-set_t *relation_domain(int n, ...) {
+relation_set_t *closure_ref(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t *);
+    set_t *universe = va_arg(args, set_t*);
 
-    set_t *result = _relation_domain(rv, universe);
+    relation_set_t *result = _closure_ref(rv, universe);
     va_end(args);
 
     return result;
 }
 
 /**
- * Finds codomain of the relation
- * @param rel_arr The array of relation pairs.
+ * Finds the symmetric closure of the relation using the bit matrix.
+ * @param rv The relation set.
  * @param universe The universe.
+ * @return The symmetric closure of the relation as a new relation set.
  */
-set_t *_relation_codomain(relation_set_t *rv, set_t *universe) {
-    set_t *codomain = set_init(0);
+relation_set_t *_closure_sym_dense(relation_set_t *rv, set_t *universe) {
+    relation_table_t *rt = relation_set_table(rv, universe);
+    relation_table_t *transposed = relation_table_transposed(rt);
+    relation_table_t *symmetric = relation_table_copy(rt);
+    relation_set_t *closure = relation_set_init(0);
+    size_t added = 0;
 
-    for (int i = 0; i < rv->size; i++) {
-        int flag = 0;
-        for (int j = 0; j < universe->size; j++) {
-            if (strcmp(rv->relations[i]->element_b, universe->elements[j]) ==
-                0) {
-                for (int k = 0; k < codomain->size; k++) {
-                    if (strcmp(rv->relations[i]->element_b,
-                               codomain->elements[k]) ==
-                        0) {
-                        flag = 1;
-                        break;
-                    }
-                }
-                if (flag == 0) {
-                    set_add(codomain, rv->relations[i]->element_b);
+    closure->symbols = rv->symbols;
+
+    /**
+     * R ∨ Rᵀ word by word.
+     */
+    for (size_t word = 0; word < (size_t) rt->rows * rt->row_words; word++) {
+        added += bit_popcount(transposed->matrix[word] & ~rt->matrix[word]);
+        symmetric->matrix[word] |= transposed->matrix[word];
+    }
+
+    relation_table_to_relation_set(symmetric, closure);
+
+    /**
+     * Few reversed pairs update a copy of the kept transitive closure,
+     * many of them are cheaper to close again.
+     */
+    if (rv->closure != NULL && rv->closure->row_items == universe &&
+        added <= (size_t) rt->rows) {
+        closure->closure = relation_table_copy(rv->closure);
+
+        for (int i = 0; i < rt->rows; i++) {
+            uint64_t *row = relation_table_row(rt, i);
+            uint64_t *row_symmetric = relation_table_row(symmetric, i);
+
+            for (uint32_t word = 0; word < rt->row_words; word++) {
+                uint64_t cells = row_symmetric[word] & ~row[word];
+
+                while (cells != 0) {
+                    relation_table_close_cell(
+                            closure->closure, i,
+                            (int) (word * BITSET_WORD_BITS) + bit_ctz(cells));
+                    cells &= cells - 1;
                 }
-                break;
             }
         }
     }
 
-    return codomain;
+    /**
+     * The symmetric table describes the new relation, keep it as its cache.
+     */
+    closure->table = symmetric;
+
+    return closure;
 }
 
 /**
- * Finds codomain of the relation_t.
- * @param n The number of relation_t.
- * @param ... The rows of relation_t and universe.
+ * Finds the symmetric closure of the sparse relation. The pairs and the
+ * reversed pairs are written to one block and normalized, which sorts
+ * them and removes the pairs found in both. Runs in O(p + |U|).
+ * @param rv The relation set.
+ * @param universe The universe.
+ * @return The symmetric closure of the relation as a new relation set.
  */
-set_t *relation_codomain(int n, ...) {
-    va_list args;
-    va_start(args, n);
+relation_set_t *_closure_sym_sparse(relation_set_t *rv, set_t *universe) {
+    relation_set_t *closure = relation_set_init(2 * rv->size);
+    size_t bytes = sizeof(uint32_t) * rv->size;
 
-    relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t *);
+    closure->symbols = rv->symbols;
 
-    set_t *result = _relation_codomain(rv, universe);
-    va_end(args);
+    memcpy(closure->elements_a, rv->elements_a, bytes);
+    memcpy(closure->elements_b, rv->elements_b, bytes);
+    memcpy(closure->elements_a + rv->size, rv->elements_b, bytes);
+    memcpy(closure->elements_b + rv->size, rv->elements_a, bytes);
+    closure->size = 2 * rv->size;
 
-    return result;
+    relation_set_normalize(closure, universe->universe_size);
+
+    return closure;
 }
 
 /**
- * Checks if the relation is injective.
- * @param rel_arr The relation
- * @param s1 The first set (domain)
- * @param s2 The second set (codomain)
- * @return True if the relation is injective, false otherwise.
+ * Finds the symmetric closure of the relation. Sparse relations merge
+ * their pairs with the reversed ones, dense ones use the bit matrix.
+ * Relations known to be symmetric are returned as a copy sharing the
+ * pairs.
+ * @param rv The relation set.
+ * @param universe The universe.
+ * @return The symmetric closure of the relation as a new relation set.
  */
-bool _relation_is_injective(relation_set_t *rv, set_t *s1, set_t *s2) {
-    for (int i = 0; i < rv->size; i++) {
-        if (set_item_index(s1, rv->relations[i]->element_a) == -1 ||
-            set_item_index(s2, rv->relations[i]->element_b) == -1) {
-            return false;
-        }
-    }
+relation_set_t *_closure_sym(relation_set_t *rv, set_t *universe) {
+    unsigned int known = relation_set_known(rv);
+    relation_set_t *closure;
 
+    if (known & RELATION_SYMMETRIC)
+        return relation_set_copy(rv);
 
-    relation_table_t *rt = relation_table_init_relation(
-            s1, s2, rv);
+    if (relation_set_layout(rv, universe) == RELATION_SPARSE)
+        closure = _closure_sym_sparse(rv, universe);
+    else
+        closure = _closure_sym_dense(rv, universe);
 
-    for (int i = 0; i < s1->size; i++) {
-        int total_in_row = 0;
-        for (int j = 0; j < s2->size; j++) {
-            if (rt->matrix[i][j] == 1) {
-                total_in_row++;
-            }
-        }
-        if (total_in_row != 1) {
-            return false;
-        }
-    }
-    for (int i = 0; i < s2->size; i++) {
-        int total_in_column = 0;
-        for (int j = 0; j < s1->size; j++) {
-            if (rt->matrix[j][i] == 1) {
-                total_in_column++;
-            }
-            if (total_in_column > 1) {
-                return false;
-            }
-        }
-    }
-    return true;
+    closure->properties = RELATION_SYMMETRIC | (known & RELATION_REFLEXIVE);
+
+    return closure;
 }
 
 /**
- * Checks if the relation is injective.
- * @param n The number of relation_t.
- * @param ... The rows of relation_t and sets.
- * @return True if the relation is injective, false otherwise.
+ * Finds the symmetric closure of the relation.
+ * @param n The number of arguments.
+ * @param ... The set of relation and the universe.
+ * @return the symmetric closure of the relation.
  */
-bool relation_is_injective(int n, ...) {
+relation_set_t *closure_sym(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *s1 = va_arg(args, set_t *);
-    set_t *s2 = va_arg(args, set_t *);
-
-    bool result = _relation_is_injective(rv, s1, s2);
+    set_t *universe = va_arg(args, set_t*);
 
+    relation_set_t *result = _closure_sym(rv, universe);
     va_end(args);
 
     return result;
 }
 
 /**
- * Checks if the relation is surjective.
- * @param rel_arr The relation
- * @param s1 The first set (domain)
- * @param s2 The second set (codomain)
- * @return True if the relation is surjective, false otherwise.
+ * Finds the transitive closure of the relation using the bit matrix. The
+ * closed matrix is kept by the relation and updated when pairs are added,
+ * so a later closure only costs the added pairs.
+ * @param rv The relation set.
+ * @param universe The universe.
+ * @return The transitive closure of the relation as a new relation set.
  */
-bool _relation_is_surjective(relation_set_t *rv, set_t *s1, set_t *s2) {
-    for (int i = 0; i < rv->size; i++) {
-        if (set_item_index(s1, rv->relations[i]->element_a) == -1 ||
-            set_item_index(s2, rv->relations[i]->element_b) == -1) {
-            return false;
-        }
-    }
+relation_set_t *_closure_trans_dense(relation_set_t *rv, set_t *universe) {
+    relation_set_t *closure = relation_set_init(0);
 
-    relation_table_t *rt = relation_table_init_relation(
-            s1, s2, rv);
+    closure->symbols = rv->symbols;
 
-    for (int i = 0; i < s1->size; i++) {
-        int total_in_row = 0;
-        for (int j = 0; j < s2->size; j++) {
-            if (rt->matrix[i][j] == 1) {
-                total_in_row++;
-            }
-        }
-        if (total_in_row != 1) {     //it has to be a function as well
-            return false;
-        }
+    if (rv->closure != NULL && rv->closure->row_items != universe) {
+        relation_table_free(rv->closure);
+        rv->closure = NULL;
     }
-    for (int i = 0; i < s2->size; i++) {
-        int total_in_column = 0;
-        for (int j = 0; j < s1->size; j++) {
-            if (rt->matrix[j][i] == 1) {
-                total_in_column++;
-            }
-        }
-        if (total_in_column == 0) {
-            return false;
-        }
+
+    if (rv->closure == NULL) {
+        relation_table_t *rt = relation_table_copy(
+                relation_set_table(rv, universe));
+
+        relation_table_close_transitive(rt);
+        rv->closure = rt;
     }
-    return true;
+
+    relation_table_to_relation_set(rv->closure, closure);
+
+    return closure;
 }
 
 /**
- * Checks if the relation is surjective.
- * @param n The number of relation_t.
- * @param ... The rows of relation_t and sets.
- * @return True if the relation is surjective, false otherwise.
+ * Finds the transitive closure of the sparse relation. Strongly connected
+ * components are condensed and reachability is computed on the condensed
+ * DAG in reverse topological order. All members of a component share one
+ * successor bitset, which is freed once all its predecessors used it.
+ * Pairs come out by components and are sorted by (a, b) at the end, so the
+ * result is the same as the one of the bit matrix.
+ * @param rv The relation set.
+ * @param universe The universe.
+ * @return The transitive closure of the relation as a new relation set.
  */
-bool relation_is_surjective(int n, ...) {
-    va_list args;
-    va_start(args, n);
+relation_set_t *_closure_trans_sparse(relation_set_t *rv, set_t *universe) {
+    uint32_t n = universe->universe_size;
+    relation_graph_t *g = relation_set_rows(rv, n);
+    relation_set_t *closure = relation_set_init(0);
+    uint32_t *components = malloc(sizeof(uint32_t) * (n + 1));
 
-    relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *s1 = va_arg(args, set_t *);
-    set_t *s2 = va_arg(args, set_t *);
+    if (components == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    bool result = _relation_is_surjective(rv, s1, s2);
+    uint32_t count = relation_graph_scc(g, components);
+    uint32_t *member_offsets = calloc(count + 1, sizeof(uint32_t));
+    uint32_t *members = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *pending = calloc(count + 1, sizeof(uint32_t));
+    bitset_t **reach = calloc(count + 1, sizeof(bitset_t *));
+
+    if (member_offsets == NULL || members == NULL || pending == NULL ||
+        reach == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    /**
+     * Group vertices by components and count edges entering each component
+     * from other components.
+     */
+    for (uint32_t v = 0; v < n; v++) {
+        member_offsets[components[v] + 1]++;
+    }
+
+    for (uint32_t c = 0; c < count; c++) {
+        member_offsets[c + 1] += member_offsets[c];
+    }
+
+    uint32_t *next = malloc(sizeof(uint32_t) * (count + 1));
+
+    if (next == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+
+    memcpy(next, member_offsets, sizeof(uint32_t) * (count + 1));
+
+    for (uint32_t v = 0; v < n; v++) {
+        members[next[components[v]]++] = v;
+
+        for (uint32_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+            if (components[g->targets[e]] != components[v])
+                pending[components[g->targets[e]]]++;
+        }
+    }
+
+    free(next);
+
+    closure->symbols = rv->symbols;
+
+    for (uint32_t c = 0; c < count; c++) {
+        bitset_t *r = bitset_init(count);
+        bool is_cyclic = member_offsets[c + 1] - member_offsets[c] > 1;
+
+        for (uint32_t m = member_offsets[c]; m < member_offsets[c + 1]; m++) {
+            uint32_t v = members[m];
+
+            for (uint32_t e = g->offsets[v]; e < g->offsets[v + 1]; e++) {
+                uint32_t d = components[g->targets[e]];
+
+                if (d == c) {
+                    is_cyclic = true;
+                    continue;
+                }
+
+                /**
+                 * Reach sets are closed, so an already reached component
+                 * adds nothing new.
+                 */
+                if (!bitset_test(r, d)) {
+                    bitset_set(r, d);
+
+                    for (uint32_t w = 0; w < r->words_count; w++) {
+                        r->words[w] |= reach[d]->words[w];
+                    }
+                }
 
-    va_end(args);
+                if (--pending[d] == 0) {
+                    bitset_free(reach[d]);
+                    reach[d] = NULL;
+                }
+            }
+        }
 
-    return result;
-}
+        if (is_cyclic)
+            bitset_set(r, c);
 
-/**
- * Checks if the relation is bijective.
- * @param rel_arr The relation
- * @param s1 The first set (domain)
- * @param s2 The second set (codomain)
- * @return True if the relation is bijective, false otherwise.
- */
-bool _relation_is_bijective(relation_set_t *rv, set_t *s1, set_t *s2) {
-    if (_relation_is_injective(rv, s1, s2) == true &&
-        _relation_is_surjective(rv, s1, s2) == true) {
-        return true;
-    } else {
-        return false;
-    }
-}
+        /**
+         * Emit pairs of every member with every reached vertex.
+         */
+        uint32_t reached = 0;
+        for (uint32_t d = bitset_next(r, 0); d < count;
+             d = bitset_next(r, d + 1)) {
+            reached += member_offsets[d + 1] - member_offsets[d];
+        }
 
-/**
- * Checks if the relation is bijective.
- * @param n The number of relation_t.
- * @param ... The rows of relation_t and sets.
- * @return True if the relation is bijective, false otherwise.
- */
-bool relation_is_bijective(int n, ...) {
-    va_list args;
-    va_start(args, n);
+        relation_set_reserve(closure, closure->size + (int) (reached *
+                (member_offsets[c + 1] - member_offsets[c])));
+
+        for (uint32_t m = member_offsets[c]; m < member_offsets[c + 1]; m++) {
+            for (uint32_t d = bitset_next(r, 0); d < count;
+                 d = bitset_next(r, d + 1)) {
+                for (uint32_t k = member_offsets[d];
+                     k < member_offsets[d + 1]; k++) {
+                    closure->elements_a[closure->size] = members[m];
+                    closure->elements_b[closure->size] = members[k];
+                    closure->size++;
+                }
+            }
+        }
 
-    relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *s1 = va_arg(args, set_t *);
-    set_t *s2 = va_arg(args, set_t *);
+        if (pending[c] == 0) {
+            bitset_free(r);
+        } else {
+            reach[c] = r;
+        }
+    }
 
-    bool result = _relation_is_bijective(rv, s1, s2);
+    free(reach);
+    free(pending);
+    free(members);
+    free(member_offsets);
+    free(components);
 
-    va_end(args);
+    relation_set_normalize(closure, n);
 
-    return result;
+    return closure;
 }
 
 /**
- * Finds the reflexive closure of the relation.
+ * Finds the transitive closure of the relation. Sparse relations use
+ * the component engine, dense ones and relations with a kept closure
+ * the bit matrix. Relations known to be transitive are returned as a copy
+ * sharing the pairs.
  * @param rv The relation set.
  * @param universe The universe.
- * @return The reflexive closure of the relation.
+ * @return The transitive closure of the relation as a new relation set.
  */
-relation_set_t *_closure_ref(relation_set_t *rv, set_t *universe) {
-    relation_table_t *rt = relation_table_init_relation(
-            universe, universe, rv);
+relation_set_t *_closure_trans(relation_set_t *rv, set_t *universe) {
+    unsigned int known = relation_set_known(rv);
+    relation_set_t *closure;
 
-    for (int i = 0; i < universe->size; i++) {
-        if (rt->matrix[i][i] == 0) {
-            rt->matrix[i][i] = 1;
-            new_relations_t *newrel = relation_init(universe->elements[i],
-                                                    universe->elements[i]);
-            relation_set_add_relation(rv, newrel);
-        }
-    }
-    return rv;
+    if (known & RELATION_TRANSITIVE)
+        return relation_set_copy(rv);
+
+    if (rv->closure == NULL &&
+        relation_set_layout(rv, universe) == RELATION_SPARSE)
+        closure = _closure_trans_sparse(rv, universe);
+    else
+        closure = _closure_trans_dense(rv, universe);
+
+    /**
+     * Paths keep reflexivity and symmetry.
+     */
+    closure->properties = RELATION_TRANSITIVE |
+                          (known & (RELATION_REFLEXIVE | RELATION_SYMMETRIC));
+
+    return closure;
 }
 
 /**
- * Finds the reflexive closure of the relation.
+ * Finds the transitive closure of the relation.
  * @param n The number of arguments.
  * @param ... The set of relation and the universe.
- * @return the reflexive closure of the relation.
+ * @return the transitive closure of the relation.
  */
-relation_set_t *closure_ref(int n, ...) {
+relation_set_t *closure_trans(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
     set_t *universe = va_arg(args, set_t*);
 
-    relation_set_t *result = _closure_ref(rv, universe);
+    relation_set_t *result = _closure_trans(rv, universe);
     va_end(args);
 
     return result;
 }
 
 /**
- * Finds the symmetric closure of the relation.
- * @param rv The relation set.
- * @param universe The universe.
- * @return The symmetric closure of the relation.
+ * Expands one level of a breadth first search. Neighbours of the frontier
+ * queue[start..end) not marked in own are marked and appended to the queue.
+ * @param g The row index (forward search) or column index (backward search).
+ * @param queue Visited elements in the order of visiting.
+ * @param start Index of the first frontier element.
+ * @param end Index after the last frontier element.
+ * @param tail Number of elements in the queue.
+ * @param own Elements visited by this search.
+ * @param other Elements visited by the opposite search.
+ * @param met Set to true when an element visited by both searches is found.
+ * @return New number of elements in the queue.
  */
-relation_set_t *_closure_sym(relation_set_t *rv, set_t *universe) {
-    relation_table_t *rt = relation_table_init_relation(universe, universe, rv);
-
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            if (rt->matrix[i][j] == 1 && rt->matrix[j][i] == 0) {
-                rt->matrix[j][i] = 1;
-                new_relations_t *newrel = relation_init(universe->elements[j],
-                                                        universe->elements[i]);
-                relation_set_add_relation(rv, newrel);
+uint32_t relation_search_expand(relation_graph_t *g, uint32_t *queue,
+                                uint32_t start, uint32_t end, uint32_t tail,
+                                bitset_t *own, bitset_t *other,
+                                bool *met) {
+    for (uint32_t i = start; i < end; i++) {
+        uint32_t u = queue[i];
+
+        for (uint32_t k = g->offsets[u]; k < g->offsets[u + 1]; k++) {
+            uint32_t w = g->targets[k];
+
+            if (bitset_test(own, w))
+                continue;
+
+            if (bitset_test(other, w)) {
+                *met = true;
+                return tail;
             }
+
+            bitset_set(own, w);
+            queue[tail++] = w;
         }
     }
-    return rv;
+
+    return tail;
 }
 
 /**
- * Finds the symmetric closure of the relation.
- * @param n The number of arguments.
- * @param ... The set of relation and the universe.
- * @return the symmetric closure of the relation.
+ * Answers reachability queries, whether (source, target) is in the
+ * transitive closure, without computing the closure. Every query runs
+ * a bidirectional breadth first search over the sparse indexes of the
+ * relation: forward from the successors of the source, backward from the
+ * target, always expanding the smaller frontier, until the searches meet.
+ * A query costs about the size of the searched subgraph. Visited bitsets
+ * are shared by the queries and cleared through the queues.
+ * @param rv The relation_set_t.
+ * @param sources The source elements.
+ * @param targets The target elements.
+ * @param count The number of queries.
+ * @param results Set to the answers of the queries.
+ * @param universe The universe.
  */
-relation_set_t *closure_sym(int n, ...) {
-    va_list args;
-    va_start(args, n);
+void _relation_reachable(relation_set_t *rv, uint32_t *sources,
+                         uint32_t *targets, int count, bool *results,
+                         set_t *universe) {
+    uint32_t n = universe->universe_size;
+    relation_graph_t *rows = relation_set_rows(rv, n);
+    relation_graph_t *columns = relation_set_columns(rv, n);
 
-    relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t*);
+    bitset_t *forward = bitset_init(n);
+    bitset_t *backward = bitset_init(n);
+    uint32_t *forward_queue = malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t *backward_queue = malloc(sizeof(uint32_t) * (n + 1));
 
-    relation_set_t *result = _closure_sym(rv, universe);
-    va_end(args);
+    if (forward_queue == NULL || backward_queue == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    return result;
+    for (int q = 0; q < count; q++) {
+        if (sources[q] >= n || targets[q] >= n)
+            print_error(__FILENAME__, __LINE__, __func__,
+                        "Element not from universe");
+
+        bool met = false;
+
+        /**
+         * The forward search holds elements reachable from the source in at
+         * least one step, the backward search elements reaching the target
+         * in any number of steps, so they meet only on a non-empty path.
+         */
+        bitset_set(backward, targets[q]);
+        backward_queue[0] = targets[q];
+        uint32_t backward_start = 0;
+        uint32_t backward_end = 1;
+
+        forward_queue[0] = sources[q];
+        uint32_t forward_end = relation_search_expand(rows, forward_queue, 0,
+                                                      1, 1, forward,
+                                                      backward, &met);
+        uint32_t forward_start = 1;
+
+        while (!met && forward_start < forward_end &&
+               backward_start < backward_end) {
+            if (forward_end - forward_start <=
+                backward_end - backward_start) {
+                uint32_t tail = relation_search_expand(
+                        rows, forward_queue, forward_start, forward_end,
+                        forward_end, forward, backward, &met);
+                forward_start = forward_end;
+                forward_end = tail;
+            } else {
+                uint32_t tail = relation_search_expand(
+                        columns, backward_queue, backward_start,
+                        backward_end, backward_end, backward, forward, &met);
+                backward_start = backward_end;
+                backward_end = tail;
+            }
+        }
+
+        results[q] = met;
+
+        for (uint32_t i = 1; i < forward_end; i++) {
+            bitset_clear(forward, forward_queue[i]);
+        }
+
+        for (uint32_t i = 0; i < backward_end; i++) {
+            bitset_clear(backward, backward_queue[i]);
+        }
+    }
+
+    free(forward_queue);
+    free(backward_queue);
+    bitset_free(forward);
+    bitset_free(backward);
 }
 
 /**
- * Finds the transitive closure of the relation.
- * @param rv The relation set.
+ * Checks if the target is reachable from the source.
+ * @param rv The relation_set_t.
+ * @param source The source element.
+ * @param target The target element.
  * @param universe The universe.
- * @return The transitive closure of the relation.
+ * @return True if (source, target) is in the transitive closure.
  */
-relation_set_t *_closure_trans(relation_set_t *rv, set_t *universe) {
-    relation_table_t *rt = relation_table_init_relation(universe, universe, rv);
-
-    for (int i = 0; i < universe->size; i++) {
-        for (int j = 0; j < universe->size; j++) {
-            for (int k = 0; k < universe->size; k++) {
-                if (rt->matrix[i][j] == 1 && rt->matrix[j][k] == 1 &&
-                    rt->matrix[i][k] == 0) {
-                    rt->matrix[i][k] = 1;
-                    new_relations_t *newrel = relation_init(
-                            universe->elements[i], universe->elements[k]);
-                    relation_set_add_relation(rv, newrel);
-                }
-            }
-        }
-    }
-    return rv;
+bool _relation_reaches(relation_set_t *rv, uint32_t source, uint32_t target,
+                       set_t *universe) {
+    bool result;
+
+    _relation_reachable(rv, &source, &target, 1, &result, universe);
+
+    return result;
 }
 
 /**
- * Finds the transitive closure of the relation.
+ * Answers reachability queries.
  * @param n The number of arguments.
- * @param ... The set of relation and the universe.
- * @return the transitive closure of the relation.
+ * @param ... The relation set, sources, targets, number of queries, results
+ * and the universe.
  */
-relation_set_t *closure_trans(int n, ...) {
+void relation_reachable(int n, ...) {
     va_list args;
     va_start(args, n);
 
     relation_set_t *rv = va_arg(args, relation_set_t *);
-    set_t *universe = va_arg(args, set_t*);
+    uint32_t *sources = va_arg(args, uint32_t *);
+    uint32_t *targets = va_arg(args, uint32_t *);
+    int count = va_arg(args, int);
+    bool *results = va_arg(args, bool *);
+    set_t *universe = va_arg(args, set_t *);
 
-    relation_set_t *result = _closure_trans(rv, universe);
+    _relation_reachable(rv, sources, targets, count, results, universe);
     va_end(args);
-
-    return result;
 }
 
 
@@ -2304,7 +5896,7 @@ void set_command_args(command_t *c, vector_t *args);
 
 void add_command_arg(command_t *c, char *arg);
 
-set_t *command_to_set(command_t *c);
+set_t *command_to_set(command_t *c, symbol_table_t *symbols);
 
 command_t *command_copy(command_t *c);
 
@@ -2318,11 +5910,15 @@ command_t *parse_command(char *s);
 
 command_t *bool_to_command(bool b);
 
+command_t *bools_to_command(bool *values, int count);
+
+command_t *profile_to_command(relation_profile_t *profile);
+
 command_t *int_to_command(int i);
 
 command_t *set_to_command(set_t *s);
 
-relation_set_t *command_to_relation_set(command_t *c);
+relation_set_t *command_to_relation_set(command_t *c, symbol_table_t *symbols);
 
 /**
  * Command system definition
@@ -2338,8 +5934,12 @@ void command_system_validate(command_system_t *cs);
 
 void command_system_init_vectors(command_system_t *cs);
 
+void command_system_update_vectors(command_system_t *cs, int index);
+
 void command_system_exec(command_system_t *cs);
 
+void command_system_stats(command_system_t *cs);
+
 void command_system_free(command_system_t *cs);
 
 /**
@@ -2358,6 +5958,11 @@ void command_vector_add(command_vector_t *cv, command_t *c);
 
 void command_vector_replace(command_vector_t *cv, command_t *c, int index);
 
+void command_vector_replace_set(command_vector_t *cv, set_t *s, int index);
+
+void command_vector_replace_relation(command_vector_t *cv, relation_set_t *rs,
+                                     int index);
+
 bool validate_command_vector(command_vector_t *cv, operation_vector_t *ov);
 
 void attach_command_system(command_vector_t *cv, command_system_t *cs);
@@ -2385,6 +5990,7 @@ typedef struct command_system_t {
     char *filename;
     command_vector_t *cv;
     operation_vector_t *operation_vector;
+    symbol_table_t *symbols;
     set_t *universe;
     set_vector_t *set_vector;
     relation_vector_t *relation_vector;
@@ -2447,25 +6053,23 @@ void add_command_arg(command_t *c, char *arg) {
 /**
  * Converts a command to a set.
  * @param c The command.
+ * @param symbols The symbol table of the universe.
  * @return The set.
  */
-set_t *command_to_set(command_t *c) {
-    set_t *s = set_init(1);
-    s->size = c->args->size;
-    s->capacity = c->args->capacity;
-    s->elements = (char **) malloc(sizeof(char *) * c->args->size);
-
+set_t *command_to_set(command_t *c, symbol_table_t *symbols) {
     if (c->type != U && c->type != S)
         print_error(__FILENAME__, __LINE__, __func__,
                     "Command type is not U or S");
 
-    if (s->elements == NULL)
-        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
+    set_t *s = set_init((int) symbols->size);
+    s->symbols = symbols;
 
     for (int i = 0; i < c->args->size; i++) {
-        s->elements[i] = c->args->elements[i];
+        set_add(s, symbol_table_find(symbols, c->args->elements[i]));
     }
 
+    set_optimize(s);
+
     return s;
 }
 
@@ -2554,7 +6158,7 @@ commands get_command_type_from_char(char c) {
 }
 
 command_t *parse_relation_command(char *str) {
-    char *rel_string = malloc(sizeof(char) * strlen(str));
+    char *rel_string = malloc(sizeof(char) * (strlen(str) + 1));
     replace_substring(rel_string, str, ") (", ")/(");
 
     remove_newlines(rel_string);
@@ -2650,6 +6254,48 @@ command_t *bool_to_command(bool b) {
     return c;
 }
 
+/**
+ * Converts booleans to command, one argument per boolean.
+ * @param values The booleans.
+ * @param count The number of booleans.
+ * @return The command.
+ */
+command_t *bools_to_command(bool *values, int count) {
+    command_t *c = init_command();
+
+    c->args = vector_init(count);
+
+    for (int i = 0; i < count; i++) {
+        vector_add(c->args, values[i] ? "true" : "false");
+    }
+
+    return c;
+}
+
+/**
+ * Converts relation profile to command, one name=value argument per
+ * property.
+ * @param profile The relation profile.
+ * @return The command.
+ */
+command_t *profile_to_command(relation_profile_t *profile) {
+    command_t *c = init_command();
+
+    c->args = vector_init(5);
+    vector_add(c->args, profile->reflexive ? "reflexive=true"
+                                           : "reflexive=false");
+    vector_add(c->args, profile->symmetric ? "symmetric=true"
+                                           : "symmetric=false");
+    vector_add(c->args, profile->antisymmetric ? "antisymmetric=true"
+                                               : "antisymmetric=false");
+    vector_add(c->args, profile->transitive ? "transitive=true"
+                                            : "transitive=false");
+    vector_add(c->args, profile->function ? "function=true"
+                                          : "function=false");
+
+    return c;
+}
+
 /**
  * Converts integer to command.
  * @param i The integer.
@@ -2680,8 +6326,9 @@ command_t *set_to_command(set_t *s) {
 
     c->type = S;
 
-    for (int i = 0; i < s->size; i++) {
-        vector_add(args, s->elements[i]);
+    set_iterator_t it;
+    for (set_iterator_init(&it, s); set_iterator_next(&it);) {
+        vector_add(args, symbol_table_name(s->symbols, it.id));
     }
 
     c->args = args;
@@ -2689,8 +6336,16 @@ command_t *set_to_command(set_t *s) {
     return c;
 }
 
-relation_set_t *command_to_relation_set(command_t *c) {
+/**
+ * Converts a command to a relation set. Elements missing in the symbol table
+ * are stored as SYMBOL_NOT_FOUND.
+ * @param c The command.
+ * @param symbols The symbol table of the universe.
+ * @return The relation set.
+ */
+relation_set_t *command_to_relation_set(command_t *c, symbol_table_t *symbols) {
     relation_set_t *rv = relation_set_init(0);
+    rv->symbols = symbols;
 
     for (int i = 0; i < c->args->size; i++) {
         char *rel_str = malloc(
@@ -2705,10 +6360,14 @@ relation_set_t *command_to_relation_set(command_t *c) {
             token = strtok(NULL, " ");
         }
 
-        new_relations_t *new_rel = relation_init(v2->elements[0],
-                                                 v2->elements[1]);
-        relation_set_add_relation(rv, new_rel);
+        relation_set_add(
+                rv,
+                v2->size > 0 ? symbol_table_find(symbols, v2->elements[0])
+                             : SYMBOL_NOT_FOUND,
+                v2->size > 1 ? symbol_table_find(symbols, v2->elements[1])
+                             : SYMBOL_NOT_FOUND);
 
+        vector_free(v2);
         free(rel_str);
         free(token);
     }
@@ -2723,11 +6382,15 @@ command_t *relation_set_to_command(relation_set_t *r) {
     c->type = R;
 
     for (int i = 0; i < r->size; i++) {
+        char *element_a = symbol_table_name(r->symbols,
+                                            r->elements_a[i]);
+        char *element_b = symbol_table_name(r->symbols,
+                                            r->elements_b[i]);
         char *vector_str = malloc(
-                sizeof(char) * (strlen(r->relations[i]->element_a) + 1));
-        string_duplicate(vector_str, r->relations[i]->element_a);
+                sizeof(char) * (strlen(element_a) + strlen(element_b) + 2));
+        string_duplicate(vector_str, element_a);
         strcat(vector_str, " ");
-        strcat(vector_str, r->relations[i]->element_b);
+        strcat(vector_str, element_b);
 
         vector_add_no_transform(args, vector_str);
 
@@ -2805,7 +6468,47 @@ void command_vector_replace(command_vector_t *cv, command_t *c, int index) {
 
     cv->commands[index] = c;
 
-    command_system_init_vectors(cv->system);
+    command_system_update_vectors(cv->system, index);
+}
+
+/**
+ * Replace a command by the resulting set. The set is added to the set
+ * vector as it is, without parsing the command back.
+ * @param cv The command vector.
+ * @param s The set, owned by the set vector afterwards.
+ * @param index The index of the command.
+ */
+void command_vector_replace_set(command_vector_t *cv, set_t *s, int index) {
+    if (index < 0 || index >= cv->size)
+        print_error(__FILENAME__, __LINE__, __FUNCTION__,
+                    "Index out of bounds");
+
+    cv->commands[index] = set_to_command(s);
+    s->index = (unsigned int) index + 1;
+
+    set_vector_add(cv->system->set_vector, s, index);
+}
+
+/**
+ * Replace a command by the resulting relation. The relation is added to the
+ * relation vector as it is, so later lines reuse the properties known from
+ * the operation instead of checking them again.
+ * @param cv The command vector.
+ * @param rs The relation, owned by the relation vector afterwards.
+ * @param index The index of the command.
+ */
+void command_vector_replace_relation(command_vector_t *cv, relation_set_t *rs,
+                                     int index) {
+    if (index < 0 || index >= cv->size)
+        print_error(__FILENAME__, __LINE__, __FUNCTION__,
+                    "Index out of bounds");
+
+    cv->commands[index] = relation_set_to_command(rs);
+    rs->index = (unsigned int) index + 1;
+    relation_set_normalize(rs, cv->system->symbols->size);
+    relation_set_place(rs, cv->system->set_vector->sets[0]);
+
+    relation_vector_add(cv->system->relation_vector, rs, index);
 }
 
 /**
@@ -2994,69 +6697,71 @@ bool validate_command_vector(command_vector_t *cv, operation_vector_t *ov) {
     free(universe_string);
 
     /**
-     * Check if universe does not contain false and true
+     * Check if there are no repeats in the universe
      */
-    for (int i = 0; i < u_command->args->size; i++)
-        if (strcmp(u_command->args->elements[i], "false") == 0 ||
-            strcmp(u_command->args->elements[i], "true") == 0) {
+    symbol_table_t *symbols = symbol_table_init(u_command->args->size);
+
+    for (int i = 0; i < u_command->args->size; i++) {
+        if (symbol_table_find(symbols, u_command->args->elements[i]) !=
+            SYMBOL_NOT_FOUND) {
             print_error(__FILENAME__, __LINE__, __FUNCTION__,
-                        "Universe contains true or false");
+                        "Universe contains repeating elements");
         }
 
+        symbol_table_add(symbols, u_command->args->elements[i]);
+    }
+
+    /**
+     * Check if universe does not contain false and true
+     */
+    if (symbol_table_find(symbols, "false") != SYMBOL_NOT_FOUND ||
+        symbol_table_find(symbols, "true") != SYMBOL_NOT_FOUND) {
+        print_error(__FILENAME__, __LINE__, __FUNCTION__,
+                    "Universe contains true or false");
+    }
+
     /**
      * Check if universe does not contain operations.
      */
     for (int i = 0; i < ov->size; i++) {
-        if (vector_contains(u_command->args, ov->operations[i]->name) ==
-            true) {
+        if (symbol_table_find(symbols, ov->operations[i]->name) !=
+            SYMBOL_NOT_FOUND) {
             print_error(__FILENAME__, __LINE__, __FUNCTION__,
                         "Universe contains operations");
         }
     }
 
     /**
-     * Check if there are no repeats in the universe
+     * Check if all sets has items only form universe and there are not
+     * repeats in S commands. Elements of the set are marked by the set number.
      */
-    for (int i = 0; i < u_command->args->size; i++) {
-        for (int j = i + 1; j < u_command->args->size; j++) {
-            if (strcmp(u_command->args->elements[i],
-                       u_command->args->elements[j]) == 0) {
-                print_error(__FILENAME__, __LINE__, __FUNCTION__,
-                            "Universe contains repeating elements");
-            }
-        }
-    }
+    uint32_t *set_marks = calloc(symbols->size + 1, sizeof(uint32_t));
+
+    if (set_marks == NULL)
+        print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
-    /**
-     * Check if all sets has items only form universe.
-     */
     for (int i = 0; i < s_commands->size; i++) {
-        for (int j = 0; j < s_commands->commands[i]->args->size; j++) {
-            if (vector_contains(u_command->args,
-                                s_commands->commands[i]->args->elements[j]) ==
-                false) {
+        command_t *s_command = s_commands->commands[i];
+        for (int j = 0; j < s_command->args->size; j++) {
+            uint32_t id = symbol_table_find(symbols,
+                                            s_command->args->elements[j]);
+
+            if (id == SYMBOL_NOT_FOUND) {
                 print_error(__FILENAME__, __LINE__, __FUNCTION__,
                             "Set contains elements not from universe");
             }
-        }
-    }
 
-    /**
-     * Check if there are not repeats in S commands
-     */
-    for (int i = 0; i < s_commands->size; i++) {
-        command_t *s_command = s_commands->commands[i];
-        for (int j = 0; j < s_command->args->size; j++) {
-            for (int k = j + 1; k < s_command->args->size; k++) {
-                if (strcmp(s_command->args->elements[j],
-                           s_command->args->elements[k]) == 0) {
-                    print_error(__FILENAME__, __LINE__, __FUNCTION__,
-                                "Set contains repeating elements");
-                }
+            if (set_marks[id] == (uint32_t) i + 1) {
+                print_error(__FILENAME__, __LINE__, __FUNCTION__,
+                            "Set contains repeating elements");
             }
+
+            set_marks[id] = i + 1;
         }
     }
 
+    free(set_marks);
+
     /**
      * Check if all operations in command vector exist
      */
@@ -3080,13 +6785,11 @@ bool validate_command_vector(command_vector_t *cv, operation_vector_t *ov) {
      */
     for (int i = 0; i < r_commands->size; i++) {
         command_t *r_command = (r_commands->commands)[i];
-        relation_set_t *rs = command_to_relation_set(r_command);
+        relation_set_t *rs = command_to_relation_set(r_command, symbols);
 
         for (int j = 0; j < rs->size; j++) {
-            if ((vector_contains(u_command->args,
-                                 rs->relations[j]->element_a) &&
-                 vector_contains(u_command->args,
-                                 rs->relations[j]->element_b)) == false) {
+            if (rs->elements_a[j] == SYMBOL_NOT_FOUND ||
+                rs->elements_b[j] == SYMBOL_NOT_FOUND) {
                 print_error(__FILENAME__, __LINE__, __FUNCTION__,
                             "Relation set contains elements not from universe");
             }
@@ -3100,23 +6803,18 @@ bool validate_command_vector(command_vector_t *cv, operation_vector_t *ov) {
      */
     for (int i = 0; i < r_commands->size; i++) {
         command_t *r_command = r_commands->commands[i];
-        relation_set_t *rs = command_to_relation_set(r_command);
+        relation_set_t *rs = command_to_relation_set(r_command, symbols);
 
-        for (int j = 0; j < rs->size; j++) {
-            for (int k = j + 1; k < rs->size; k++) {
-                if (strcmp(rs->relations[j]->element_a,
-                           rs->relations[k]->element_a) == 0 &&
-                    strcmp(rs->relations[j]->element_b,
-                           rs->relations[k]->element_b) == 0) {
-                    print_error(__FILENAME__, __LINE__, __FUNCTION__,
-                                "Relation set contains repeating elements");
-                }
-            }
+        if (relation_set_normalize(rs, symbols->size) > 0) {
+            print_error(__FILENAME__, __LINE__, __FUNCTION__,
+                        "Relation set contains repeating elements");
         }
 
         relation_set_free(rs);
     }
 
+    symbol_table_free(symbols);
+
     return true;
 }
 
@@ -3275,11 +6973,12 @@ command_vector_t *parse_file(char *filename) {
     if (fp == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "File not found");
 
-    char line[300];
+    char *line;
 
-    while (fgets(line, 255, fp) != NULL) {
+    while ((line = read_line(fp)) != NULL) {
         command_t *c = parse_command(line);
         command_vector_add(cv, c);
+        free(line);
     }
 
     fclose(fp);
@@ -3506,6 +7205,7 @@ command_system_t *command_system_init(char *filename) {
         print_error(__FILENAME__, __LINE__, __func__, "Malloc failed");
 
     cs->filename = filename;
+    cs->symbols = NULL;
     cs->cv = parse_file(filename);
     attach_command_system(cs->cv, cs);
 
@@ -3554,10 +7254,14 @@ void command_system_init_base(command_system_t *cs) {
             "closure_ref",
             "closure_sym",
             "closure_trans",
+            "profile",
+            "inverse",
+            "reachable",
     };
 
     int relation_operations_argc[RELATION_OPERATIONS_COUNT] = {1, 1, 1, 1, 1, 1,
-                                                               1, 1, 1, 1};
+                                                               1, 1, 1, 1, 1,
+                                                               1, 3};
 
     char *common_operations[COMMON_OPERATIONS_COUNT] = {
             "injective",
@@ -3626,25 +7330,51 @@ void command_system_init_vectors(command_system_t *cs) {
 
     command_t *universe_command = find_command_by_type(cs->cv, U);
 
-    set_vector_add(cs->set_vector, command_to_set(universe_command), 1);
+    /**
+     * Intern universe elements. Universe does not change during execution,
+     * so the symbol table is built only once.
+     */
+    if (cs->symbols == NULL)
+        cs->symbols = symbol_table_init_vector(universe_command->args);
+
+    set_vector_add(cs->set_vector,
+                   command_to_set(universe_command, cs->symbols), 1);
 
     for (int i = 0; i < cs->cv->size; i++) {
-        if (cs->cv->commands[i]->type == S) {
-            set_t *set = set_init_indexed(i + 1,
-                                          cs->cv->commands[i]->args->size);
+        command_system_update_vectors(cs, i);
+    }
+}
 
-            for (int j = 0; j < cs->cv->commands[i]->args->size; j++) {
-                set_add(set, cs->cv->commands[i]->args->elements[j]);
-            }
+/**
+ * Adds the set or the relation of the command at the index to the vectors.
+ * Called for every line at start and for every replaced line, so sets
+ * and relations of other lines (and their cached tables) are kept.
+ * @param cs The command system.
+ * @param index The index of the command.
+ */
+void command_system_update_vectors(command_system_t *cs, int index) {
+    command_t *command = cs->cv->commands[index];
 
-            set_vector_add(cs->set_vector, set, i);
-        } else if (cs->cv->commands[i]->type == R) {
-            command_t *command = cs->cv->commands[i];
-            relation_set_t *relation_set = command_to_relation_set(command);
-            relation_set->index = i + 1;
+    if (command->type == S) {
+        set_t *set = set_init_indexed(index + 1, (int) cs->symbols->size);
+        set->symbols = cs->symbols;
 
-            relation_vector_add(cs->relation_vector, relation_set, i);
+        for (int j = 0; j < command->args->size; j++) {
+            set_add(set, symbol_table_find(cs->symbols,
+                                           command->args->elements[j]));
         }
+
+        set_optimize(set);
+
+        set_vector_add(cs->set_vector, set, index);
+    } else if (command->type == R) {
+        relation_set_t *relation_set = command_to_relation_set(
+                command, cs->symbols);
+        relation_set->index = index + 1;
+        relation_set_normalize(relation_set, cs->symbols->size);
+        relation_set_place(relation_set, cs->set_vector->sets[0]);
+
+        relation_vector_add(cs->relation_vector, relation_set, index);
     }
 }
 
@@ -3665,7 +7395,14 @@ void command_system_exec(command_system_t *cs) {
         operation *operation = operation_vector_find(cs->operation_vector,
                                                      operation_name);
 
-        if (operation->argc != command->args->size - 1)
+        /**
+         * Reachability takes the relation and any number of element pairs.
+         */
+        bool is_batch = strcmp(operation_name, "reachable") == 0 &&
+                        command->args->size - 1 > operation->argc &&
+                        (command->args->size - 1 - operation->argc) % 2 == 0;
+
+        if (operation->argc != command->args->size - 1 && !is_batch)
             print_error(__FILENAME__, __LINE__, __func__,
                         "Invalid number of arguments");
 
@@ -3751,26 +7488,26 @@ void command_system_exec(command_system_t *cs) {
                     set_vector_find(cs->set_vector, 1),
                     set_vector_find(cs->set_vector, first_index));
 
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if (strcmp(operation_name, "union") == 0) {
             set_t *s = set_union(
                     2,
                     set_vector_find(cs->set_vector, first_index),
                     set_vector_find(cs->set_vector, second_index));
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if (strcmp(operation_name, "intersect") == 0) {
             set_t *s = set_intersection(
                     2,
                     set_vector_find(cs->set_vector, first_index),
                     set_vector_find(cs->set_vector, second_index));
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if (strcmp(operation_name, "minus") == 0) {
             set_t *s = set_diff(
                     2,
                     set_vector_find(cs->set_vector, first_index),
                     set_vector_find(cs->set_vector, second_index));
 
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if (strcmp(operation_name, "subseteq") == 0) {
             bool is_subseteq = set_is_subseteq(
                     2,
@@ -3832,19 +7569,30 @@ void command_system_exec(command_system_t *cs) {
                     cs->set_vector->sets[0]);
 
             command_vector_replace(cs->cv, bool_to_command(is_function), i);
+        } else if (strcmp(operation_name, "profile") == 0) {
+            relation_profile_t *profile = relation_set_profile(
+                    relation_vector_find(cs->relation_vector, first_index),
+                    cs->set_vector->sets[0]);
+
+            command_vector_replace(cs->cv, profile_to_command(profile), i);
+        } else if (strcmp(operation_name, "inverse") == 0) {
+            relation_set_t *rs = relation_set_inverse(
+                    relation_vector_find(cs->relation_vector, first_index));
+
+            command_vector_replace_relation(cs->cv, rs, i);
         } else if (strcmp(operation_name, "domain") == 0) {
             set_t *s = relation_domain(
                     2,
                     relation_vector_find(cs->relation_vector, first_index),
                     cs->set_vector->sets[0]);
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if (strcmp(operation_name, "codomain") == 0) {
             set_t *s = relation_codomain(
                     2,
                     relation_vector_find(cs->relation_vector, first_index),
                     cs->set_vector->sets[0]);
 
-            command_vector_replace(cs->cv, set_to_command(s), i);
+            command_vector_replace_set(cs->cv, s, i);
         } else if ((strcmp(operation_name, "injective") == 0) ||
                    (strcmp(operation_name, "surjective") == 0) ||
                    (strcmp(operation_name, "bijective") == 0)) {
@@ -3889,7 +7637,7 @@ void command_system_exec(command_system_t *cs) {
                                                      first_index),
                                              cs->set_vector->sets[0]);
 
-            command_vector_replace(cs->cv, relation_set_to_command(rs), i);
+            command_vector_replace_relation(cs->cv, rs, i);
         } else if (strcmp(operation_name, "closure_sym") == 0) {
             relation_set_t *rs = closure_sym(2,
                                              relation_vector_find(
@@ -3897,7 +7645,7 @@ void command_system_exec(command_system_t *cs) {
                                                      first_index),
                                              cs->set_vector->sets[0]);
 
-            command_vector_replace(cs->cv, relation_set_to_command(rs), i);
+            command_vector_replace_relation(cs->cv, rs, i);
         } else if (strcmp(operation_name, "closure_trans") == 0) {
             relation_set_t *rs = closure_trans(2,
                                                relation_vector_find(
@@ -3905,11 +7653,69 @@ void command_system_exec(command_system_t *cs) {
                                                        first_index),
                                                cs->set_vector->sets[0]);
 
-            command_vector_replace(cs->cv, relation_set_to_command(rs), i);
+            command_vector_replace_relation(cs->cv, rs, i);
+        } else if (strcmp(operation_name, "reachable") == 0) {
+            int count = (command->args->size - 2) / 2;
+            uint32_t *sources = malloc(sizeof(uint32_t) * count);
+            uint32_t *targets = malloc(sizeof(uint32_t) * count);
+            bool *results = malloc(sizeof(bool) * count);
+
+            if (sources == NULL || targets == NULL || results == NULL)
+                print_error(__FILENAME__, __LINE__, __func__,
+                            "Malloc failed");
+
+            for (int j = 0; j < count; j++) {
+                sources[j] = symbol_table_find(
+                        cs->symbols, command->args->elements[2 + 2 * j]);
+                targets[j] = symbol_table_find(
+                        cs->symbols, command->args->elements[3 + 2 * j]);
+
+                if (sources[j] == SYMBOL_NOT_FOUND ||
+                    targets[j] == SYMBOL_NOT_FOUND)
+                    print_error(__FILENAME__, __LINE__, __func__,
+                                "Element not from universe");
+            }
+
+            relation_reachable(6,
+                               relation_vector_find(cs->relation_vector,
+                                                    first_index),
+                               sources, targets, count, results,
+                               cs->set_vector->sets[0]);
+
+            command_vector_replace(cs->cv, bools_to_command(results, count),
+                                   i);
+            free(sources);
+            free(targets);
+            free(results);
         }
     }
 }
 
+/**
+ * Prints the sparse density threshold, the matrix algorithm, the profile
+ * counters and the layout of every relation to stderr.
+ * @param cs The command system.
+ */
+void command_system_stats(command_system_t *cs) {
+    set_t *universe = cs->set_vector->sets[0];
+
+    fprintf(stderr, "sparse density: 1/%d\n", options.sparse_density);
+    fprintf(stderr, "algorithm: %s\n",
+            options.algorithm == RELATION_FOUR_RUSSIANS
+            ? "four-russians" : "bitwise");
+    fprintf(stderr, "profiles: %lu computed, %lu checks known\n",
+            counters.profiles, counters.known);
+
+    for (int i = 0; i < cs->relation_vector->size; i++) {
+        relation_set_t *rv = cs->relation_vector->relations[i];
+
+        fprintf(stderr, "R %u: %s, %d pairs, %d elements\n", rv->index,
+                relation_set_layout(rv, universe) == RELATION_SPARSE
+                ? "sparse" : "dense",
+                rv->size, _set_card(universe));
+    }
+}
+
 void command_system_free(command_system_t *cs) {
     if (cs == NULL)
         print_error(__FILENAME__, __LINE__, __func__, "Invalid pointer");
@@ -3918,11 +7724,13 @@ void command_system_free(command_system_t *cs) {
     operation_vector_free(cs->operation_vector);
     set_vector_free(cs->set_vector);
     relation_vector_free(cs->relation_vector);
+    symbol_table_free(cs->symbols);
 
     free(cs);
 }
 
 
+#ifndef SETCAL_NO_MAIN
 /**
  * Main function.
  * @param argc The number of arguments.
@@ -3930,17 +7738,19 @@ void command_system_free(command_system_t *cs) {
  * @return 0 if the program ran successfully, 1 otherwise.
  */
 int main(int argc, char *argv[]) {
-    if (argc != 2)
-        print_error(__FILENAME__, __LINE__, __func__,
-                    "Invalid number of arguments");
+    options_parse(argc, argv);
 
-    command_system_t *cs = command_system_init(argv[1]);
+    command_system_t *cs = command_system_init(options.file);
 
     command_system_exec(cs);
 
     command_vector_print(cs->cv);
 
+    if (options.stats)
+        command_system_stats(cs);
+
     command_system_free(cs);
 
     return 0;
 }
+#endif
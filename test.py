@@ -56,7 +56,10 @@ class Tester:
             print(e)
             return
 
-    def compare_output(self, output, stdout):
+    def compare_output(self, output, stdout, exact=False):
+        if exact:
+            return output.rstrip() == stdout.rstrip()
+
         out_list = output.rstrip().split('\n')
         stdout_list = stdout.rstrip().split('\n')
 
@@ -73,7 +76,7 @@ class Tester:
                 return False
         return True
 
-    def test(self, test_name, args, output_file="", intentional_error=False):
+    def test(self, test_name, args, output_file="", intentional_error=False, error_file="", exact=False):
         self.test_count += 1
         error = False
         msg = ""
@@ -106,12 +109,21 @@ class Tester:
             out_file = open(output_file, "r")
             output = out_file.read()
 
-            if not self.compare_output(output, p.stdout):
+            if not self.compare_output(output, p.stdout, exact):
                 error = True
                 msg += 'Vystup programu se neshoduje s predpokladanym vystupem!\n'
 
             out_file.close()
 
+        if error_file != "":
+            err_file = open(error_file, "r")
+
+            if err_file.read() != p.stderr:
+                error = True
+                msg += 'Chybovy vystup programu se neshoduje s predpokladanym!\n'
+
+            err_file.close()
+
         if intentional_error and p.stderr == '':
             error = True
             msg += 'Program nevratil na STDERR zadnou chybovou zpravu!\n'
@@ -172,6 +184,26 @@ if __name__ == '__main__':
     t1.test('Bez argumentu', [], intentional_error=True)
     t1.test('Moc argumentu', ['tests/sets.txt', 'tests/rel.txt'], intentional_error=True)
     t1.test('Neexistujici soubor', ['tests/a'], intentional_error=True)
+    t1.test('Pocet vlaken', ['--threads', '4', 'tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+    t1.test('Jedno vlakno, 300 prvku', ['--threads', '1', 'tests/closure_trans/11.txt'], 'tests/closure_trans/11_res.txt', exact=True)
+    t1.test('Ctyri vlakna, 300 prvku', ['--threads', '4', 'tests/closure_trans/11.txt'], 'tests/closure_trans/11_res.txt', exact=True)
+    t1.test('Ctyri vlakna, Ctyri Rusove, 300 prvku', ['--threads', '4', '--algorithm', 'four-russians', 'tests/closure_trans/11.txt'], 'tests/closure_trans/11_res.txt', exact=True)
+    t1.test('Neplatny pocet vlaken', ['--threads', '0', 'tests/closure_trans/8.txt'], intentional_error=True)
+    t1.test('Neznamy prepinac', ['--foo', 'tests/closure_trans/8.txt'], intentional_error=True)
+    t1.test('Ridke relace', ['--sparse-density', '1', 'tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+    t1.test('Huste relace', ['--sparse-density', '1048576', 'tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+    t1.test('Ridky reflexivni uzaver', ['--sparse-density', '1', 'tests/closure_ref/4.txt'], 'tests/closure_ref/4_res.txt')
+    t1.test('Poradi ridkeho tranzitivniho uzaveru', ['--sparse-density', '1', 'tests/closure_trans/10.txt'], 'tests/closure_trans/10_res.txt', exact=True)
+    t1.test('Poradi husteho tranzitivniho uzaveru', ['tests/closure_trans/10.txt'], 'tests/closure_trans/10_res.txt', exact=True)
+    t1.test('Poradi ridkeho reflexivniho uzaveru', ['--sparse-density', '1', 'tests/closure_ref/7.txt'], 'tests/closure_ref/7_res.txt', exact=True)
+    t1.test('Poradi husteho reflexivniho uzaveru', ['--sparse-density', '1048576', 'tests/closure_ref/7.txt'], 'tests/closure_ref/7_res.txt', exact=True)
+    t1.test('Ridky symetricky uzaver', ['--sparse-density', '1', 'tests/closure_sym/4.txt'], 'tests/closure_sym/4_res.txt')
+    t1.test('Neplatna hustota', ['--sparse-density', 'x', 'tests/closure_trans/8.txt'], intentional_error=True)
+    t1.test('Statistiky', ['--stats', 'tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+    t1.test('Statistiky zname vlastnosti', ['--stats', 'tests/transitive/8.txt'], 'tests/transitive/8_res.txt', error_file='tests/transitive/8_stats.txt')
+    t1.test('Ctyri Rusove', ['--algorithm', 'four-russians', '--sparse-density', '1048576', 'tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+    t1.test('Ctyri Rusove tranzitivita', ['--algorithm', 'four-russians', '--sparse-density', '1048576', 'tests/transitive/4.txt'], 'tests/transitive/4_res.txt')
+    t1.test('Neznamy algoritmus', ['--algorithm', 'x', 'tests/closure_trans/8.txt'], intentional_error=True)
 
     # Testovani univerza
     t1.test('Univerzum #01 Cisla ve jmenech prvku', ['tests/universe/1.txt'], intentional_error=True)
@@ -379,10 +411,11 @@ if __name__ == '__main__':
     t1.test('Prikaz "transitive" #3 Tranzitivni relace 1', ['tests/transitive/3.txt'], 'tests/transitive/3_res.txt')
     t1.test('Prikaz "transitive" #4 Tranzitivni relace 2', ['tests/transitive/4.txt'], 'tests/transitive/4_res.txt')
     t1.test('Prikaz "transitive" #5 Netranzitivni relace', ['tests/transitive/5.txt'], 'tests/transitive/5_res.txt')
-    t1.test('Prikaz "transitive" #6 Mnozina', ['tests/transitive/6.txt'], intentional_error=True)
-    t1.test('Prikaz "transitive" #7 Univerzum', ['tests/transitive/7.txt'], intentional_error=True)
-    t1.test('Prikaz "transitive" #8 Zadny parametr', ['tests/transitive/no_param.txt'], intentional_error=True)
-    t1.test('Prikaz "transitive" #9 Moc parametru', ['tests/transitive/too_many.txt'], intentional_error=True)
+    t1.test('Prikaz "transitive" #6 Uzavery relace', ['tests/transitive/8.txt'], 'tests/transitive/8_res.txt')
+    t1.test('Prikaz "transitive" #7 Mnozina', ['tests/transitive/6.txt'], intentional_error=True)
+    t1.test('Prikaz "transitive" #8 Univerzum', ['tests/transitive/7.txt'], intentional_error=True)
+    t1.test('Prikaz "transitive" #9 Zadny parametr', ['tests/transitive/no_param.txt'], intentional_error=True)
+    t1.test('Prikaz "transitive" #10 Moc parametru', ['tests/transitive/too_many.txt'], intentional_error=True)
 
     # Command domain
     t1.test('Prikaz "domain" #1 Prazdne univerzum, prazdna relace', ['tests/domain/1.txt'], 'tests/domain/1_res.txt')
@@ -417,6 +450,32 @@ if __name__ == '__main__':
     t1.test('Prikaz "function" #8 Zadny parametr', ['tests/function/no_param.txt'], intentional_error=True)
     t1.test('Prikaz "function" #9 Moc parametru', ['tests/function/too_many.txt'], intentional_error=True)
 
+    # Command profile
+    t1.test('Prikaz "profile" #1 Prazdne univerzum, prazdna relace', ['tests/profile/1.txt'], 'tests/profile/1_res.txt')
+    t1.test('Prikaz "profile" #2 Ekvivalence', ['tests/profile/2.txt'], 'tests/profile/2_res.txt')
+    t1.test('Prikaz "profile" #3 Retezec', ['tests/profile/3.txt'], 'tests/profile/3_res.txt')
+    t1.test('Prikaz "profile" #4 Spolu s vlastnostmi', ['tests/profile/4.txt'], 'tests/profile/4_res.txt')
+    t1.test('Prikaz "profile" #5 Mnozina', ['tests/profile/5.txt'], intentional_error=True)
+    t1.test('Prikaz "profile" #6 Ridka relace', ['tests/profile/6.txt'], 'tests/profile/6_res.txt')
+    t1.test('Prikaz "profile" #7 Zadny parametr', ['tests/profile/no_param.txt'], intentional_error=True)
+    t1.test('Prikaz "profile" #8 Moc parametru', ['tests/profile/too_many.txt'], intentional_error=True)
+
+    # Command inverse
+    t1.test('Prikaz "inverse" #1 Relace', ['tests/inverse/1.txt'], 'tests/inverse/1_res.txt')
+    t1.test('Prikaz "inverse" #2 Prazdne univerzum, prazdna relace', ['tests/inverse/2.txt'], 'tests/inverse/2_res.txt')
+    t1.test('Prikaz "inverse" #3 Dvojita inverze', ['tests/inverse/3.txt'], 'tests/inverse/3_res.txt')
+    t1.test('Prikaz "inverse" #4 Mnozina', ['tests/inverse/4.txt'], intentional_error=True)
+    t1.test('Prikaz "inverse" #5 Zadny parametr', ['tests/inverse/no_param.txt'], intentional_error=True)
+    t1.test('Prikaz "inverse" #6 Moc parametru', ['tests/inverse/too_many.txt'], intentional_error=True)
+
+    # Command reachable
+    t1.test('Prikaz "reachable" #1 Retezec', ['tests/reachable/1.txt'], 'tests/reachable/1_res.txt')
+    t1.test('Prikaz "reachable" #2 Vice dvojic, cykly', ['tests/reachable/2.txt'], 'tests/reachable/2_res.txt')
+    t1.test('Prikaz "reachable" #3 Mnozina', ['tests/reachable/3.txt'], intentional_error=True)
+    t1.test('Prikaz "reachable" #4 Prvek mimo univerzum', ['tests/reachable/4.txt'], intentional_error=True)
+    t1.test('Prikaz "reachable" #5 Lichy pocet prvku', ['tests/reachable/5.txt'], intentional_error=True)
+    t1.test('Prikaz "reachable" #6 Zadny parametr', ['tests/reachable/no_param.txt'], intentional_error=True)
+
     # Command surjective
     t1.test('Prikaz "surjective"', ['tests/surjective/1.txt'], 'tests/surjective/1_res.txt')
 
@@ -458,10 +517,12 @@ if __name__ == '__main__':
         t2.test('Prikaz "closure_trans" #3 Tranzitivni relace 1', ['tests/closure_trans/3.txt'], 'tests/closure_trans/3_res.txt')
         t2.test('Prikaz "closure_trans" #4 Tranzitivni relace 2', ['tests/closure_trans/4.txt'], 'tests/closure_trans/4_res.txt')
         t2.test('Prikaz "closure_trans" #5 Netranzitivni relace, nekolik iteraci', ['tests/closure_trans/5.txt'], 'tests/closure_trans/5_res.txt')
-        t2.test('Prikaz "closure_trans" #6 Mnozina', ['tests/closure_trans/6.txt'], intentional_error=True)
-        t2.test('Prikaz "closure_trans" #7 Univerzum', ['tests/closure_trans/7.txt'], intentional_error=True)
-        t2.test('Prikaz "closure_trans" #8 Zadny parametr', ['tests/closure_trans/no_param.txt'], intentional_error=True)
-        t2.test('Prikaz "closure_trans" #9 Moc parametru', ['tests/closure_trans/too_many.txt'], intentional_error=True)
+        t2.test('Prikaz "closure_trans" #6 Retezec proti poradi prvku', ['tests/closure_trans/8.txt'], 'tests/closure_trans/8_res.txt')
+        t2.test('Prikaz "closure_trans" #7 Uzaver po reflexivnim a symetrickem uzaveru', ['tests/closure_trans/9.txt'], 'tests/closure_trans/9_res.txt')
+        t2.test('Prikaz "closure_trans" #8 Mnozina', ['tests/closure_trans/6.txt'], intentional_error=True)
+        t2.test('Prikaz "closure_trans" #9 Univerzum', ['tests/closure_trans/7.txt'], intentional_error=True)
+        t2.test('Prikaz "closure_trans" #10 Zadny parametr', ['tests/closure_trans/no_param.txt'], intentional_error=True)
+        t2.test('Prikaz "closure_trans" #11 Moc parametru', ['tests/closure_trans/too_many.txt'], intentional_error=True)
 
         # Command select
         t2.test('Prikaz "select" #1 Jednoprvkova mnozina', ['tests/select/1.txt'], 'tests/select/1_res.txt')